@@ -0,0 +1,471 @@
+// Benchmark de regressão do caminho de decodificação.
+//
+// Gera tráfego sintético (TCP/UDP/ICMP, IPv4/IPv6, quadros pequenos e grandes, respostas DNS e
+// datagramas fragmentados) e entrega cada quadro a Sniffer::processFrame (via injectFrame), o mesmo
+// caminho do callback do pcap: contadores, TrafficSeries, detector de anomalias, remontagem,
+// busca de assinaturas, decodificação de aplicação, cache de nomes, FrameStore e ring até o merge.
+// Relata ns/pacote, alocações/pacote e pico de RSS. Retorna 1 se algum limite for ultrapassado.
+//
+// Uso:
+//   PacketSnifferBench [--packets N] [--max-ns X] [--max-allocs Y] [--max-rss-mb Z]
+//                      [--baseline arquivo] [--tolerance 0.20] [--save-baseline arquivo]
+
+#include "sniffer.hpp"
+#include "traffic.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sys/resource.h>
+
+using namespace std;
+
+// ===== CONTAGEM DE ALOCAÇÕES =====
+// Intercepta malloc/calloc/realloc no próprio executável. O Qt 6 aloca os dados das QStrings
+// (QArrayData) direto com malloc/realloc, fora do operator new; contando neste nível, essas
+// alocações entram na conta, assim como as do operator new (que usa malloc por baixo).
+// As implementações reais são as da glibc (__libc_*).
+static atomic<uint64_t> allocationCount{0};
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* p, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* p);
+
+    void* malloc(size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* p, size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        return __libc_realloc(p, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        void* p = __libc_memalign(alignment, size);
+        if (!p)
+        {
+            return ENOMEM;
+        }
+        *result = p;
+        return 0;
+    }
+
+    void free(void* p) noexcept
+    {
+        __libc_free(p);
+    }
+}
+
+// Destino volátil que impede o compilador de descartar o trabalho medido
+static volatile uint64_t benchmarkSink;
+
+// ===== CENÁRIOS =====
+enum class FrameShape
+{
+    Plain,       // Quadros do TrafficGenerator, como estão
+    DnsReply,    // Respostas DNS com um registro A (decodificação + inserção no cache de nomes)
+    Fragmented   // Datagramas UDP/IPv4 grandes divididos em dois fragmentos (remontagem)
+};
+
+struct Scenario
+{
+    string name;
+    vector<FrameSpec> mix;  // Quadros intercalados em round-robin
+    FrameShape shape = FrameShape::Plain;
+};
+
+struct ScenarioResult
+{
+    double nsPerPacket;
+    double allocsPerPacket;
+};
+
+static vector<Scenario> buildScenarios()
+{
+    const uint32_t SMALL = 64;
+    const uint32_t LARGE = 1514;
+
+    vector<Scenario> scenarios = {
+        {"tcp4-small",  {{TrafficProtocol::TCP,  IPVersion::V4, SMALL, 0, 0}}},
+        {"tcp4-large",  {{TrafficProtocol::TCP,  IPVersion::V4, LARGE, 0, 0}}},
+        {"udp4-small",  {{TrafficProtocol::UDP,  IPVersion::V4, SMALL, 0, 0}}},
+        {"udp4-large",  {{TrafficProtocol::UDP,  IPVersion::V4, LARGE, 0, 0}}},
+        {"icmp4",       {{TrafficProtocol::ICMP, IPVersion::V4, 98,    0, 0}}},
+        {"tcp6-small",  {{TrafficProtocol::TCP,  IPVersion::V6, 86,    0, 0}}},
+        {"udp6-large",  {{TrafficProtocol::UDP,  IPVersion::V6, LARGE, 0, 0}}},
+    };
+
+    Scenario mixed{"mixed", {}};
+    for (const Scenario& s : scenarios)
+    {
+        mixed.mix.push_back(s.mix[0]);
+    }
+    scenarios.push_back(mixed);
+
+    scenarios.push_back({"dns4-reply", {{TrafficProtocol::UDP, IPVersion::V4, SMALL, 0, 0}}, FrameShape::DnsReply});
+    scenarios.push_back({"udp4-frag", {{TrafficProtocol::UDP, IPVersion::V4, LARGE, 0, 0}}, FrameShape::Fragmented});
+
+    return scenarios;
+}
+
+static void put16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+static void fixIPv4Checksum(uint8_t* ip)
+{
+    put16(ip + 10, 0);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < 20; i += 2)
+    {
+        sum += (static_cast<uint32_t>(ip[i]) << 8) | ip[i + 1];
+    }
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    put16(ip + 10, static_cast<uint16_t>(~sum));
+}
+
+// Resposta de 192.168.0.53:53 ao cliente do fluxo: hostN.bench.example A 10.1.x.y
+static vector<uint8_t> buildDnsReply(const FrameSpec& spec)
+{
+    const size_t IP_OFFSET = 14;
+    const size_t UDP_OFFSET = IP_OFFSET + 20;
+    const size_t DNS_OFFSET = UDP_OFFSET + 8;
+
+    vector<uint8_t> frame = TrafficGenerator::buildFrame(spec);
+    frame.resize(DNS_OFFSET);
+
+    // Cabeçalho: resposta, RD+RA, 1 pergunta, 1 resposta
+    const uint8_t header[12] = {0x12, 0x34, 0x81, 0x80, 0, 1, 0, 1, 0, 0, 0, 0};
+    frame.insert(frame.end(), header, header + sizeof(header));
+
+    string host = "host" + to_string(spec.flowId);
+    frame.push_back(static_cast<uint8_t>(host.size()));
+    frame.insert(frame.end(), host.begin(), host.end());
+    for (const char* label : {"bench", "example"})
+    {
+        frame.push_back(static_cast<uint8_t>(strlen(label)));
+        frame.insert(frame.end(), label, label + strlen(label));
+    }
+    const uint8_t question[5] = {0, 0, 1, 0, 1};   // Fim do nome, tipo A, classe IN
+    frame.insert(frame.end(), question, question + sizeof(question));
+
+    // Resposta apontando para o nome da pergunta (0xC00C), TTL 300, 4 bytes
+    const uint8_t answer[16] = {0xC0, 0x0C, 0, 1, 0, 1, 0, 0, 0x01, 0x2C, 0, 4,
+                                10, 1, static_cast<uint8_t>(spec.flowId >> 8), static_cast<uint8_t>(spec.flowId)};
+    frame.insert(frame.end(), answer, answer + sizeof(answer));
+
+    uint8_t* ip = frame.data() + IP_OFFSET;
+    uint8_t* udp = frame.data() + UDP_OFFSET;
+    put16(ip + 2, static_cast<uint16_t>(frame.size() - IP_OFFSET));
+    copy(ip + 12, ip + 16, ip + 16);                // O cliente do fluxo vira o destino
+    const uint8_t server[4] = {192, 168, 0, 53};
+    copy(server, server + 4, ip + 12);
+    fixIPv4Checksum(ip);
+
+    put16(udp + 2, static_cast<uint16_t>((udp[0] << 8) | udp[1]));
+    put16(udp, 53);
+    put16(udp + 4, static_cast<uint16_t>(frame.size() - UDP_OFFSET));
+    put16(udp + 6, 0);
+    return frame;
+}
+
+// Divide o datagrama IPv4 do quadro em dois fragmentos (o primeiro com um múltiplo de 8 bytes)
+static void appendFragments(const vector<uint8_t>& frame, vector<vector<uint8_t>>& frames)
+{
+    const size_t IP_OFFSET = 14;
+    const size_t HEADERS = IP_OFFSET + 20;
+    size_t dataLength = frame.size() - HEADERS;
+    size_t firstLength = (dataLength / 2) & ~static_cast<size_t>(7);
+
+    for (int part = 0; part < 2; part++)
+    {
+        size_t offset = part == 0 ? 0 : firstLength;
+        size_t length = part == 0 ? firstLength : dataLength - firstLength;
+
+        vector<uint8_t> fragment(frame.begin(), frame.begin() + HEADERS);
+        fragment.insert(fragment.end(), frame.begin() + HEADERS + offset, frame.begin() + HEADERS + offset + length);
+
+        uint8_t* ip = fragment.data() + IP_OFFSET;
+        put16(ip + 2, static_cast<uint16_t>(20 + length));
+        put16(ip + 6, static_cast<uint16_t>((part == 0 ? 0x2000 : 0) | (offset / 8)));   // MF e offset
+        fixIPv4Checksum(ip);
+        frames.push_back(move(fragment));
+    }
+}
+
+// Pré-gera os quadros para que a geração não entre na medição
+static vector<vector<uint8_t>> generateFrames(const Scenario& scenario, size_t count)
+{
+    vector<vector<uint8_t>> frames;
+    frames.reserve(count);
+
+    for (size_t i = 0; frames.size() < count; i++)
+    {
+        FrameSpec spec = scenario.mix[i % scenario.mix.size()];
+        spec.flowId = static_cast<uint32_t>(i % 256);
+        spec.sequence = static_cast<uint32_t>(i);
+
+        switch (scenario.shape)
+        {
+            case FrameShape::Plain: frames.push_back(TrafficGenerator::buildFrame(spec)); break;
+            case FrameShape::DnsReply: frames.push_back(buildDnsReply(spec)); break;
+            case FrameShape::Fragmented: appendFragments(TrafficGenerator::buildFrame(spec), frames); break;
+        }
+    }
+
+    return frames;
+}
+
+// Relógio do pcap simulado (1 pacote por µs), contínuo entre cenários e repetições
+static int64_t captureClockUs = 0;
+
+static ScenarioResult runScenario(Sniffer& sniffer, const Scenario& scenario, size_t packets)
+{
+    const size_t DISTINCT_FRAMES = 1024;
+    vector<vector<uint8_t>> frames = generateFrames(scenario, DISTINCT_FRAMES);
+
+    vector<pcap_pkthdr> headers(frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        headers[i].caplen = static_cast<uint32_t>(frames[i].size());
+        headers[i].len = static_cast<uint32_t>(frames[i].size());
+    }
+
+    // Um quadro pelo caminho do callback; o ring é esvaziado a cada quadro, como faria o merge,
+    // para que a amostragem nunca entre em ação e todas as linhas sejam montadas
+    SpscRing<CapturedRow>& ring = sniffer.getRing();
+    CapturedRow row;
+    uint64_t checksum = 0;
+
+    auto feed = [&](size_t i)
+    {
+        captureClockUs++;
+        pcap_pkthdr& header = headers[i];
+        header.ts.tv_sec = static_cast<time_t>(captureClockUs / 1000000);
+        header.ts.tv_usec = static_cast<suseconds_t>(captureClockUs % 1000000);
+        sniffer.injectFrame(&header, frames[i].data());
+
+        while (ring.pop(row))
+        {
+            checksum += row.length + row.matchCount;
+        }
+    };
+
+    // Aquecimento
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        feed(i);
+    }
+
+    // Melhor de REPETITIONS execuções, para reduzir o ruído de agendamento
+    const int REPETITIONS = 3;
+    ScenarioResult best{0, 0};
+
+    for (int rep = 0; rep < REPETITIONS; rep++)
+    {
+        uint64_t allocsBefore = allocationCount.load(memory_order_relaxed);
+        auto start = chrono::steady_clock::now();
+
+        for (size_t n = 0; n < packets; n++)
+        {
+            feed(n % frames.size());
+        }
+
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        uint64_t allocs = allocationCount.load(memory_order_relaxed) - allocsBefore;
+
+        double ns = static_cast<double>(elapsed) / packets;
+        if (rep == 0 || ns < best.nsPerPacket)
+        {
+            best = {ns, static_cast<double>(allocs) / packets};
+        }
+    }
+
+    benchmarkSink = checksum;
+
+    return best;
+}
+
+static long peakRssKb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // KB no Linux
+}
+
+static map<string, ScenarioResult> loadBaseline(const string& path)
+{
+    map<string, ScenarioResult> baseline;
+    ifstream in(path);
+    string name;
+    ScenarioResult r;
+    while (in >> name >> r.nsPerPacket >> r.allocsPerPacket)
+    {
+        baseline[name] = r;
+    }
+    return baseline;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t packets = 200000;
+    double maxNs = 0;
+    double maxAllocs = -1;
+    double maxRssMb = 0;
+    double tolerance = 0.20;
+    string baselinePath;
+    string saveBaselinePath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--packets" && hasValue) packets = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-ns" && hasValue) maxNs = atof(argv[++i]);
+        else if (arg == "--max-allocs" && hasValue) maxAllocs = atof(argv[++i]);
+        else if (arg == "--max-rss-mb" && hasValue) maxRssMb = atof(argv[++i]);
+        else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--tolerance" && hasValue) tolerance = atof(argv[++i]);
+        else if (arg == "--save-baseline" && hasValue) saveBaselinePath = argv[++i];
+        else
+        {
+            cerr << "Argumento inválido: " << arg << endl;
+            return 2;
+        }
+    }
+
+    if (packets == 0)
+    {
+        cerr << "--packets deve ser maior que zero" << endl;
+        return 2;
+    }
+
+    // A interceptação precisa enxergar as alocações do Qt; sem isso o limite de alocações não vale nada
+    {
+        uint64_t before = allocationCount.load(memory_order_relaxed);
+        QString probe = QString::number(packets);
+        benchmarkSink = static_cast<uint64_t>(probe.size());
+        if (allocationCount.load(memory_order_relaxed) == before)
+        {
+            cerr << "A contagem de alocações não registrou QString::number; malloc não foi interceptado" << endl;
+            return 2;
+        }
+    }
+
+    map<string, ScenarioResult> baseline;
+    if (!baselinePath.empty())
+    {
+        // Baseline pedido mas ausente não pode virar uma comparação que sempre passa
+        baseline = loadBaseline(baselinePath);
+        if (baseline.empty())
+        {
+            cerr << "Baseline " << baselinePath << " não encontrado ou vazio (grave um com --save-baseline)" << endl;
+            return 2;
+        }
+    }
+
+    // Uma interface sintética para todos os cenários; nenhum dispositivo é aberto.
+    // As assinaturas garantem que a busca rode em todo payload (a primeira aparece nos quadros grandes).
+    Sniffer sniffer("bench");
+    auto matcher = make_shared<PatternMatcher>();
+    matcher->addPattern("seq", {0x10, 0x11, 0x12, 0x13});
+    matcher->addPattern("deadbeef", {0xde, 0xad, 0xbe, 0xef});
+    matcher->compile();
+    sniffer.setPatternMatcher(matcher);
+
+    map<string, ScenarioResult> results;
+    bool failed = false;
+
+    cout << left << setw(14) << "cenario" << right << setw(12) << "ns/pacote"
+         << setw(14) << "alocs/pacote" << "  status" << "\n";
+
+    for (const Scenario& scenario : buildScenarios())
+    {
+        ScenarioResult r = runScenario(sniffer, scenario, packets);
+        results[scenario.name] = r;
+
+        string status = "ok";
+        if (maxNs > 0 && r.nsPerPacket > maxNs)
+        {
+            status = "REGRESSAO (ns > " + to_string(maxNs) + ")";
+        }
+        if (maxAllocs >= 0 && r.allocsPerPacket > maxAllocs)
+        {
+            status = "REGRESSAO (alocs > " + to_string(maxAllocs) + ")";
+        }
+
+        auto it = baseline.find(scenario.name);
+        if (it != baseline.end())
+        {
+            if (r.nsPerPacket > it->second.nsPerPacket * (1.0 + tolerance))
+            {
+                status = "REGRESSAO (ns vs baseline " + to_string(it->second.nsPerPacket) + ")";
+            }
+            if (r.allocsPerPacket > it->second.allocsPerPacket + 0.5)
+            {
+                status = "REGRESSAO (alocs vs baseline " + to_string(it->second.allocsPerPacket) + ")";
+            }
+        }
+
+        if (status != "ok")
+        {
+            failed = true;
+        }
+
+        cout << left << setw(14) << scenario.name << right << fixed << setprecision(1)
+             << setw(12) << r.nsPerPacket << setw(14) << r.allocsPerPacket << "  " << status << "\n";
+    }
+
+    double rssMb = peakRssKb() / 1024.0;
+    cout << "Pico de RSS: " << fixed << setprecision(1) << rssMb << " MB";
+    if (maxRssMb > 0 && rssMb > maxRssMb)
+    {
+        cout << "  REGRESSAO (> " << maxRssMb << " MB)";
+        failed = true;
+    }
+    cout << endl;
+
+    if (!saveBaselinePath.empty())
+    {
+        ofstream out(saveBaselinePath);
+        for (const auto& [name, r] : results)
+        {
+            out << name << " " << r.nsPerPacket << " " << r.allocsPerPacket << "\n";
+        }
+        cout << "Baseline gravado em " << saveBaselinePath << endl;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,564 @@
+// Gerador de tráfego sintético determinístico para testes de carga da captura.
+//
+// Monta quadros TCP/UDP/ICMP sobre IPv4/IPv6 com TrafficGenerator e os grava num arquivo
+// pcap ou os injeta numa interface local (lo, veth) a uma taxa controlada. A sequência de
+// quadros depende só da semente e das opções: a mesma linha de comando produz o mesmo
+// arquivo, byte a byte, e injeta os mesmos quadros na mesma ordem.
+//
+// No modo rampa, a taxa sobe em degraus e, ao fim de cada degrau, os contadores de descarte
+// do Sniffer são lidos do endpoint de métricas; a ferramenta relata a primeira taxa em que
+// os descartes começam.
+//
+// Uso:
+//   PacketSnifferTrafficGen (--output arquivo.pcap | --interface nome)
+//                           [--seed N] [--mix tcp=60,udp=30,icmp=10] [--ipv6 0.25]
+//                           [--flows N] [--size 60 | 60-1514 | imix]
+//                           [--packets N | --duration segundos] [--pps taxa] [--pool N]
+//                           [--ramp inicio:passo:maximo] [--step-seconds S]
+//                           [--metrics-port P] [--metrics-interface nome]
+
+#include "traffic.hpp"
+#include <pcap.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <random>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// Início fixo dos timestamps gravados no pcap (2024-01-01 00:00:00 UTC), para que o
+// arquivo não dependa do relógio da máquina
+static const int64_t PCAP_EPOCH_NS = 1704067200LL * 1000000000LL;
+
+// ===== OPÇÕES =====
+struct GeneratorOptions
+{
+    uint64_t seed = 1;
+    double protocolWeights[3] = {60, 30, 10};   // TCP, UDP, ICMP
+    double ipv6Fraction = 0.25;
+    uint32_t flows = 1024;
+    uint32_t minSize = 60;
+    uint32_t maxSize = 1514;
+    bool imix = false;
+    uint64_t packets = 100000;
+    double durationSeconds = 0;                 // Quando > 0, substitui --packets
+    double pps = 10000;
+    size_t pool = 8192;
+
+    string outputPath;
+    string interfaceName;
+
+    double rampStart = 0;
+    double rampStep = 0;
+    double rampMax = 0;
+    double stepSeconds = 5;
+    uint16_t metricsPort = 9101;
+    string metricsInterface;
+};
+
+static bool parseMix(const string& text, double weights[3])
+{
+    fill(weights, weights + 3, 0.0);
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        size_t eq = item.find('=');
+        if (eq == string::npos)
+        {
+            return false;
+        }
+        string name = item.substr(0, eq);
+        double weight = atof(item.c_str() + eq + 1);
+        if (weight < 0)
+        {
+            return false;
+        }
+
+        if (name == "tcp") weights[0] = weight;
+        else if (name == "udp") weights[1] = weight;
+        else if (name == "icmp") weights[2] = weight;
+        else return false;
+    }
+    return weights[0] + weights[1] + weights[2] > 0;
+}
+
+static bool parseSize(const string& text, GeneratorOptions& options)
+{
+    if (text == "imix")
+    {
+        options.imix = true;
+        return true;
+    }
+
+    char* end = nullptr;
+    unsigned long low = strtoul(text.c_str(), &end, 10);
+    unsigned long high = low;
+    if (end && *end == '-')
+    {
+        high = strtoul(end + 1, &end, 10);
+    }
+    // Fora dessa faixa o gerador ajustaria o tamanho em silêncio
+    if (!end || *end != '\0' || high < low || low < TrafficGenerator::MIN_FRAME_SIZE ||
+        high > TrafficGenerator::MAX_FRAME_SIZE)
+    {
+        cerr << "--size aceita de " << TrafficGenerator::MIN_FRAME_SIZE << " a " << TrafficGenerator::MAX_FRAME_SIZE
+             << " bytes" << endl;
+        return false;
+    }
+
+    options.minSize = static_cast<uint32_t>(low);
+    options.maxSize = static_cast<uint32_t>(high);
+    return true;
+}
+
+static bool parseRamp(const string& text, GeneratorOptions& options)
+{
+    double values[3];
+    stringstream ss(text);
+    string item;
+    for (double& value : values)
+    {
+        if (!getline(ss, item, ':'))
+        {
+            return false;
+        }
+        value = atof(item.c_str());
+    }
+
+    options.rampStart = values[0];
+    options.rampStep = values[1];
+    options.rampMax = values[2];
+    return options.rampStart > 0 && options.rampStep > 0 && options.rampMax >= options.rampStart;
+}
+
+// ===== SEQUÊNCIA DE QUADROS =====
+// Sorteia as especificações dos quadros a partir da semente. A saída do mt19937_64 é
+// especificada pelo padrão, mas as distribuições da biblioteca não; por isso os sorteios
+// são feitos aqui, consumindo o gerador numa ordem fixa por quadro.
+class FrameSequence
+{
+    public:
+        explicit FrameSequence(const GeneratorOptions& o) : options(o), rng(o.seed)
+        {
+            double total = o.protocolWeights[0] + o.protocolWeights[1] + o.protocolWeights[2];
+            protocolThresholds[0] = o.protocolWeights[0] / total;
+            protocolThresholds[1] = (o.protocolWeights[0] + o.protocolWeights[1]) / total;
+        }
+
+        FrameSpec next()
+        {
+            static const uint32_t IMIX_SIZES[] = {60, 590, 1514};
+
+            FrameSpec spec;
+            double p = unit();
+            spec.protocol = p < protocolThresholds[0] ? TrafficProtocol::TCP
+                          : p < protocolThresholds[1] ? TrafficProtocol::UDP
+                          : TrafficProtocol::ICMP;
+            spec.ipVersion = unit() < options.ipv6Fraction ? IPVersion::V6 : IPVersion::V4;
+            spec.flowId = static_cast<uint32_t>(below(max<uint32_t>(options.flows, 1)));
+
+            if (options.imix)
+            {
+                // 7:4:1 entre quadros pequenos, médios e grandes
+                uint64_t slot = below(12);
+                spec.frameSize = IMIX_SIZES[slot < 7 ? 0 : slot < 11 ? 1 : 2];
+            }
+            else
+            {
+                spec.frameSize = options.minSize + static_cast<uint32_t>(below(options.maxSize - options.minSize + 1));
+            }
+
+            spec.sequence = sequence++;
+            return spec;
+        }
+
+    private:
+        const GeneratorOptions& options;
+        mt19937_64 rng;
+        double protocolThresholds[2];
+        uint32_t sequence = 0;
+
+        // [0, 1) com os 53 bits mais altos
+        double unit() { return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0); }
+
+        // [0, n); o viés do módulo é desprezível para n pequeno frente a 2^64
+        uint64_t below(uint64_t n) { return rng() % n; }
+};
+
+// ===== RITMO =====
+// Agenda o pacote i em inicio + i/pps. Longe do prazo, dorme; perto dele, espera ativa,
+// já que sleep_for sozinho não tem resolução para taxas acima de algumas dezenas de kpps.
+class Pacer
+{
+    public:
+        explicit Pacer(double pps) : intervalNs(1e9 / pps), start(Clock::now())
+        {
+        }
+
+        void wait(uint64_t index)
+        {
+            auto target = start + chrono::nanoseconds(static_cast<int64_t>(index * intervalNs));
+            auto now = Clock::now();
+            if (target - now > chrono::microseconds(200))
+            {
+                this_thread::sleep_for(target - now - chrono::microseconds(100));
+            }
+            while (Clock::now() < target)
+            {
+            }
+        }
+
+    private:
+        double intervalNs;
+        Clock::time_point start;
+};
+
+// ===== ARQUIVO PCAP =====
+static int writePcap(const GeneratorOptions& options)
+{
+    pcap_t* dead = pcap_open_dead(DLT_EN10MB, 65535);
+    pcap_dumper_t* dumper = dead ? pcap_dump_open(dead, options.outputPath.c_str()) : nullptr;
+    if (!dumper)
+    {
+        cerr << "Erro ao criar " << options.outputPath << ": " << (dead ? pcap_geterr(dead) : "pcap_open_dead") << endl;
+        if (dead)
+        {
+            pcap_close(dead);
+        }
+        return 1;
+    }
+
+    uint64_t packets = options.durationSeconds > 0
+                     ? static_cast<uint64_t>(options.durationSeconds * options.pps)
+                     : options.packets;
+
+    FrameSequence sequence(options);
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < packets; i++)
+    {
+        vector<uint8_t> frame = TrafficGenerator::buildFrame(sequence.next());
+
+        // Timestamps sintéticos na taxa pedida, a partir de uma época fixa
+        int64_t ns = PCAP_EPOCH_NS + static_cast<int64_t>(i * (1e9 / options.pps));
+        pcap_pkthdr header{};
+        header.ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        header.ts.tv_usec = static_cast<suseconds_t>((ns % 1000000000) / 1000);
+        header.caplen = static_cast<bpf_u_int32>(frame.size());
+        header.len = header.caplen;
+
+        pcap_dump(reinterpret_cast<u_char*>(dumper), &header, frame.data());
+        bytes += frame.size();
+    }
+
+    pcap_dump_close(dumper);
+    pcap_close(dead);
+
+    cout << packets << " pacotes (" << bytes << " bytes) gravados em " << options.outputPath << endl;
+    return 0;
+}
+
+// ===== INJEÇÃO =====
+struct InjectResult
+{
+    uint64_t sent = 0;
+    uint64_t failed = 0;
+    double seconds = 0;
+};
+
+// Os quadros são montados antes da medição: buildFrame aloca, e o custo de montagem
+// limitaria a taxa atingível. O conjunto é percorrido em ciclo.
+static vector<vector<uint8_t>> buildPool(const GeneratorOptions& options)
+{
+    FrameSequence sequence(options);
+    vector<vector<uint8_t>> pool;
+    pool.reserve(options.pool);
+    for (size_t i = 0; i < options.pool; i++)
+    {
+        pool.push_back(TrafficGenerator::buildFrame(sequence.next()));
+    }
+    return pool;
+}
+
+static InjectResult inject(pcap_t* handle, const vector<vector<uint8_t>>& pool, double pps, uint64_t packets)
+{
+    InjectResult result;
+    Pacer pacer(pps);
+    auto start = Clock::now();
+
+    for (uint64_t i = 0; i < packets; i++)
+    {
+        pacer.wait(i);
+        const vector<uint8_t>& frame = pool[i % pool.size()];
+        if (pcap_inject(handle, frame.data(), frame.size()) < 0)
+        {
+            result.failed++;
+        }
+        else
+        {
+            result.sent++;
+        }
+    }
+
+    result.seconds = chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+// ===== MÉTRICAS DO SNIFFER =====
+struct DropCounters
+{
+    bool valid = false;
+    uint64_t received = 0;   // packetsniffer_pcap_received_total
+    uint64_t dropped = 0;    // pcap (ps_drop + ps_ifdrop) + fila da interface cheia
+};
+
+// GET /metrics no servidor local do sniffer (HTTP/1.0, a conexão fecha ao fim da resposta)
+static string fetchMetrics(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return "";
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    string response;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+    {
+        const char request[] = "GET /metrics HTTP/1.0\r\nHost: 127.0.0.1\r\n\r\n";
+        if (send(fd, request, sizeof(request) - 1, 0) == static_cast<ssize_t>(sizeof(request) - 1))
+        {
+            char buffer[4096];
+            ssize_t n;
+            while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+            {
+                response.append(buffer, static_cast<size_t>(n));
+            }
+        }
+    }
+    close(fd);
+    return response;
+}
+
+static DropCounters readDropCounters(uint16_t port, const string& iface)
+{
+    DropCounters counters;
+    string body = fetchMetrics(port);
+    string label = "{interface=\"" + iface + "\"} ";
+
+    stringstream ss(body);
+    string line;
+    while (getline(ss, line))
+    {
+        size_t pos = line.find(label);
+        if (pos == string::npos || line[0] == '#')
+        {
+            continue;
+        }
+
+        string name = line.substr(0, pos);
+        uint64_t value = strtoull(line.c_str() + pos + label.size(), nullptr, 10);
+
+        if (name == "packetsniffer_pcap_received_total")
+        {
+            counters.received = value;
+            counters.valid = true;
+        }
+        else if (name == "packetsniffer_pcap_dropped_total" || name == "packetsniffer_pcap_ifdropped_total" ||
+                 name == "packetsniffer_ring_dropped_total")
+        {
+            counters.dropped += value;
+        }
+    }
+    return counters;
+}
+
+// Espera a fila do sniffer esvaziar e o loop de captura (que lê pcap_stats a cada
+// READ_TIMEOUT_MS) publicar os contadores do degrau
+static void settle()
+{
+    this_thread::sleep_for(chrono::seconds(1));
+}
+
+static int runRamp(pcap_t* handle, const GeneratorOptions& options, const vector<vector<uint8_t>>& pool)
+{
+    string iface = options.metricsInterface.empty() ? options.interfaceName : options.metricsInterface;
+
+    settle();
+    DropCounters before = readDropCounters(options.metricsPort, iface);
+    if (!before.valid)
+    {
+        cerr << "Métricas de \"" << iface << "\" não encontradas em http://127.0.0.1:" << options.metricsPort
+             << "/metrics (o sniffer está capturando nessa interface?)" << endl;
+        return 1;
+    }
+
+    cout << right << setw(12) << "pps alvo" << setw(12) << "pps real" << setw(12) << "enviados"
+         << setw(12) << "recebidos" << setw(12) << "descartes" << "\n";
+
+    double lastClean = 0;
+    double firstDropping = 0;
+
+    for (double pps = options.rampStart; pps <= options.rampMax + 1e-9; pps += options.rampStep)
+    {
+        uint64_t packets = max<uint64_t>(1, static_cast<uint64_t>(pps * options.stepSeconds));
+        InjectResult result = inject(handle, pool, pps, packets);
+        settle();
+
+        DropCounters after = readDropCounters(options.metricsPort, iface);
+        uint64_t received = after.received - before.received;
+        uint64_t dropped = after.dropped - before.dropped;
+        before = after;
+
+        double achieved = result.seconds > 0 ? result.sent / result.seconds : 0;
+        cout << fixed << setprecision(0) << setw(12) << pps << setw(12) << achieved << setw(12) << result.sent
+             << setw(12) << received << setw(12) << dropped << endl;
+
+        // O gerador não acompanhou a taxa: os degraus seguintes não testariam nada novo
+        if (achieved < pps * 0.95)
+        {
+            cout << "O gerador atingiu o limite em ~" << fixed << setprecision(0) << achieved
+                 << " pps; a rampa foi interrompida." << endl;
+            break;
+        }
+
+        if (dropped > 0)
+        {
+            firstDropping = pps;
+            break;
+        }
+        lastClean = pps;
+    }
+
+    if (firstDropping > 0 && lastClean == 0)
+    {
+        cout << "Descartes já no primeiro degrau (" << fixed << setprecision(0) << firstDropping
+             << " pps); reduza o início da rampa" << endl;
+    }
+    else if (firstDropping > 0)
+    {
+        cout << "Descartes começam em " << fixed << setprecision(0) << firstDropping << " pps (último degrau sem descartes: "
+             << lastClean << " pps)" << endl;
+    }
+    else if (lastClean > 0)
+    {
+        cout << "Nenhum descarte até " << fixed << setprecision(0) << lastClean << " pps" << endl;
+    }
+    return 0;
+}
+
+static int injectTraffic(const GeneratorOptions& options)
+{
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t* handle = pcap_open_live(options.interfaceName.c_str(), 65535, 0, 1, errbuf);
+    if (!handle)
+    {
+        cerr << "Erro ao abrir " << options.interfaceName << ": " << errbuf << endl;
+        return 1;
+    }
+
+    // O handle só injeta: o filtro que rejeita tudo (o mesmo da pausa do Sniffer) impede que o
+    // kernel copie para este processo o tráfego da interface, inclusive os próprios quadros injetados
+    bpf_program rejectAll{};
+    if (pcap_compile(handle, &rejectAll, "less 0", 1, PCAP_NETMASK_UNKNOWN) != 0 || pcap_setfilter(handle, &rejectAll) != 0)
+    {
+        cerr << "Aviso: não foi possível desativar a captura em " << options.interfaceName << ": "
+             << pcap_geterr(handle) << endl;
+    }
+    pcap_freecode(&rejectAll);
+
+    vector<vector<uint8_t>> pool = buildPool(options);
+
+    int status = 0;
+    if (options.rampStart > 0)
+    {
+        status = runRamp(handle, options, pool);
+    }
+    else
+    {
+        uint64_t packets = options.durationSeconds > 0
+                         ? static_cast<uint64_t>(options.durationSeconds * options.pps)
+                         : options.packets;
+        InjectResult result = inject(handle, pool, options.pps, packets);
+
+        cout << result.sent << " pacotes injetados em " << options.interfaceName << " em " << fixed << setprecision(2)
+             << result.seconds << " s (" << setprecision(0) << (result.seconds > 0 ? result.sent / result.seconds : 0)
+             << " pps)";
+        if (result.failed > 0)
+        {
+            cout << ", " << result.failed << " falhas de pcap_inject: " << pcap_geterr(handle);
+        }
+        cout << endl;
+    }
+
+    pcap_close(handle);
+    return status;
+}
+
+int main(int argc, char* argv[])
+{
+    GeneratorOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+
+        if (arg == "--seed" && hasValue) options.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--mix" && hasValue) valid = parseMix(argv[++i], options.protocolWeights);
+        else if (arg == "--ipv6" && hasValue) options.ipv6Fraction = atof(argv[++i]);
+        else if (arg == "--flows" && hasValue) options.flows = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--size" && hasValue) valid = parseSize(argv[++i], options);
+        else if (arg == "--packets" && hasValue) options.packets = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--duration" && hasValue) options.durationSeconds = atof(argv[++i]);
+        else if (arg == "--pps" && hasValue) options.pps = atof(argv[++i]);
+        else if (arg == "--pool" && hasValue) options.pool = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--output" && hasValue) options.outputPath = argv[++i];
+        else if (arg == "--interface" && hasValue) options.interfaceName = argv[++i];
+        else if (arg == "--ramp" && hasValue) valid = parseRamp(argv[++i], options);
+        else if (arg == "--step-seconds" && hasValue) options.stepSeconds = atof(argv[++i]);
+        else if (arg == "--metrics-port" && hasValue) options.metricsPort = static_cast<uint16_t>(atoi(argv[++i]));
+        else if (arg == "--metrics-interface" && hasValue) options.metricsInterface = argv[++i];
+        else valid = false;
+
+        if (!valid)
+        {
+            cerr << "Argumento inválido: " << arg << endl;
+            return 2;
+        }
+    }
+
+    if (options.outputPath.empty() == options.interfaceName.empty())
+    {
+        cerr << "Informe exatamente um destino: --output arquivo.pcap ou --interface nome" << endl;
+        return 2;
+    }
+    if (options.pps <= 0 || options.pool == 0 || options.stepSeconds <= 0 ||
+        (options.packets == 0 && options.durationSeconds <= 0))
+    {
+        cerr << "--pps, --pool, --step-seconds e --packets/--duration devem ser maiores que zero" << endl;
+        return 2;
+    }
+    if (options.rampStart > 0 && options.interfaceName.empty())
+    {
+        cerr << "--ramp exige --interface" << endl;
+        return 2;
+    }
+
+    return options.outputPath.empty() ? injectTraffic(options) : writePcap(options);
+}
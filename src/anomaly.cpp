@@ -0,0 +1,411 @@
+#include "anomaly.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+static size_t addressLength(uint8_t ipVersion)
+{
+    return ipVersion == 6 ? 16 : 4;
+}
+
+// FNV-1a seguido do finalizador do splitmix64: os bits altos (usados pelo HyperLogLog)
+// também precisam ser bem distribuídos
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static uint64_t hashAddress(uint8_t ipVersion, const uint8_t* addr, uint64_t extra = 0)
+{
+    uint64_t h = 14695981039346656037ULL ^ ipVersion;
+    for (size_t i = 0; i < addressLength(ipVersion); i++)
+    {
+        h = (h ^ addr[i]) * 1099511628211ULL;
+    }
+    return mix(h ^ (extra * 0x9e3779b97f4a7c15ULL));
+}
+
+// ===== ALERT =====
+const char* Alert::kindName() const
+{
+    switch (kind)
+    {
+        case AlertKind::SynFlood: return "syn_flood";
+        case AlertKind::PortScan: return "port_scan";
+        case AlertKind::FanOut: return "fan_out";
+    }
+    return "unknown";
+}
+
+string Alert::addressString() const
+{
+    char text[INET6_ADDRSTRLEN];
+    inet_ntop(ipVersion == 6 ? AF_INET6 : AF_INET, addr, text, sizeof(text));
+    return text;
+}
+
+string Alert::describe() const
+{
+    ostringstream oss;
+    switch (kind)
+    {
+        case AlertKind::SynFlood:
+            oss << "SYN flood contra " << addressString() << ": ~" << estimate << " SYNs sem resposta";
+            break;
+        case AlertKind::PortScan:
+            oss << "Varredura de portas a partir de " << addressString() << ": ~" << estimate << " portas";
+            break;
+        case AlertKind::FanOut:
+            oss << "Fan-out a partir de " << addressString() << ": ~" << estimate << " hosts";
+            break;
+    }
+    oss << " em " << AnomalyDetector::WINDOW_MS / 1000 << " s";
+    return oss.str();
+}
+
+string Alert::toJson(const string& interface) const
+{
+    // Nomes de interface não costumam ter aspas, mas o JSON precisa continuar válido
+    string escaped;
+    for (char c : interface)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+
+    ostringstream oss;
+    oss << "{\"timestamp_ms\":" << timestampMs
+        << ",\"interface\":\"" << escaped << "\""
+        << ",\"kind\":\"" << kindName() << "\""
+        << ",\"address\":\"" << addressString() << "\""
+        << ",\"estimate\":" << estimate
+        << ",\"threshold\":" << threshold
+        << ",\"window_ms\":" << AnomalyDetector::WINDOW_MS << "}";
+    return oss.str();
+}
+
+// ===== HYPERLOGLOG =====
+bool HyperLogLog::add(uint64_t hash)
+{
+    // 6 bits escolhem o registrador; o restante dá a posição do primeiro bit 1
+    size_t index = static_cast<size_t>(hash >> 58);
+    uint64_t rest = hash << 6;
+    uint8_t rank = rest == 0 ? 59 : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+
+    if (rank <= registers[index])
+    {
+        return false;
+    }
+    registers[index] = rank;
+    return true;
+}
+
+uint64_t HyperLogLog::estimate() const
+{
+    const double m = static_cast<double>(REGISTERS);
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t r : registers)
+    {
+        sum += ldexp(1.0, -r);
+        zeros += r == 0;
+    }
+
+    double estimate = 0.709 * m * m / sum;
+
+    // Poucos elementos: contagem linear pelos registradores vazios
+    if (estimate <= 2.5 * m && zeros > 0)
+    {
+        estimate = m * log(m / static_cast<double>(zeros));
+    }
+    return static_cast<uint64_t>(llround(estimate));
+}
+
+// ===== COUNT-MIN =====
+void WindowedCountMin::clear()
+{
+    for (size_t i = 0; i < DEPTH; i++)
+    {
+        current[i].fill(0);
+        previous[i].fill(0);
+    }
+    windowStartMs = 0;
+}
+
+void WindowedCountMin::rotate(int64_t nowMs, int64_t windowMs)
+{
+    int64_t elapsed = nowMs - windowStartMs;
+    if (elapsed < windowMs)
+    {
+        return;
+    }
+
+    if (elapsed < 2 * windowMs)
+    {
+        previous = current;
+        windowStartMs += windowMs;
+    }
+    else
+    {
+        // Nada visto na janela anterior inteira (ou primeira chamada)
+        for (auto& row : previous)
+        {
+            row.fill(0);
+        }
+        windowStartMs = nowMs;
+    }
+
+    for (auto& row : current)
+    {
+        row.fill(0);
+    }
+}
+
+uint64_t WindowedCountMin::add(uint64_t hash, int64_t nowMs, int64_t windowMs)
+{
+    rotate(nowMs, windowMs);
+
+    // Linhas independentes a partir de dois hashes (h1 + i * h2)
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    for (size_t i = 0; i < DEPTH; i++)
+    {
+        uint32_t& counter = current[i][(h1 + i * h2) % WIDTH];
+        if (counter != UINT32_MAX)
+        {
+            counter++;
+        }
+    }
+    return estimate(hash, nowMs, windowMs);
+}
+
+uint64_t WindowedCountMin::estimate(uint64_t hash, int64_t nowMs, int64_t windowMs)
+{
+    rotate(nowMs, windowMs);
+
+    double previousWeight = 1.0 - static_cast<double>(nowMs - windowStartMs) / windowMs;
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+
+    double best = 0.0;
+    for (size_t i = 0; i < DEPTH; i++)
+    {
+        size_t column = (h1 + i * h2) % WIDTH;
+        double value = current[i][column] + previous[i][column] * previousWeight;
+        if (i == 0 || value < best)
+        {
+            best = value;
+        }
+    }
+    return static_cast<uint64_t>(best);
+}
+
+// ===== DETECTOR =====
+void AnomalyDetector::clear()
+{
+    synsByDestination.clear();
+    synAcksBySource.clear();
+    sources.fill(Source());
+    recentTargets.fill(RecentTarget());
+    nextRecentTarget = 0;
+}
+
+bool AnomalyDetector::observe(const FlowKey& key, int64_t nowMs, Alert& alert)
+{
+    if (key.ipVersion == 0 || (key.protocol != IPPROTO_TCP && key.protocol != IPPROTO_UDP))
+    {
+        return false;
+    }
+
+    bool syn = key.protocol == IPPROTO_TCP && (key.tcpFlags & TH_SYN);
+    bool ack = key.protocol == IPPROTO_TCP && (key.tcpFlags & TH_ACK);
+
+    // Resposta do servidor: conta como handshake atendido para a origem (o destino do SYN)
+    if (syn && ack)
+    {
+        synAcksBySource.add(hashAddress(key.ipVersion, key.srcAddr), nowMs, WINDOW_MS);
+        return false;
+    }
+
+    // Só tentativas de conexão entram nas varreduras: SYN do TCP e datagramas UDP que não sejam
+    // respostas. Um datagrama de uma porta de serviço para uma porta efêmera é a resposta de um
+    // servidor (DNS, NTP, QUIC) e não conta contra ele.
+    if (key.protocol == IPPROTO_TCP && !syn)
+    {
+        return false;
+    }
+    if (key.protocol == IPPROTO_UDP && key.srcPort < SERVICE_PORT_LIMIT && key.dstPort >= SERVICE_PORT_LIMIT)
+    {
+        return false;
+    }
+
+    if (syn && checkSynFlood(key, nowMs, alert))
+    {
+        return true;
+    }
+    return checkSource(key, nowMs, alert);
+}
+
+bool AnomalyDetector::checkSynFlood(const FlowKey& key, int64_t nowMs, Alert& alert)
+{
+    uint64_t hash = hashAddress(key.ipVersion, key.dstAddr);
+    uint64_t syns = synsByDestination.add(hash, nowMs, WINDOW_MS);
+    if (syns < SYN_FLOOD_THRESHOLD)
+    {
+        return false;
+    }
+
+    // Muitos SYNs respondidos são só um servidor movimentado
+    uint64_t synAcks = synAcksBySource.estimate(hash, nowMs, WINDOW_MS);
+    if (syns < SYN_FLOOD_RATIO * max<uint64_t>(synAcks, 1))
+    {
+        return false;
+    }
+
+    size_t length = addressLength(key.ipVersion);
+    for (const RecentTarget& target : recentTargets)
+    {
+        if (target.ipVersion == key.ipVersion && nowMs - target.alertedMs < WINDOW_MS &&
+            memcmp(target.addr, key.dstAddr, length) == 0)
+        {
+            return false;
+        }
+    }
+
+    RecentTarget& target = recentTargets[nextRecentTarget];
+    nextRecentTarget = (nextRecentTarget + 1) % RECENT_TARGETS;
+    target.ipVersion = key.ipVersion;
+    memcpy(target.addr, key.dstAddr, sizeof(target.addr));
+    target.alertedMs = nowMs;
+
+    alert.kind = AlertKind::SynFlood;
+    alert.timestampMs = nowMs;
+    alert.ipVersion = key.ipVersion;
+    memcpy(alert.addr, key.dstAddr, sizeof(alert.addr));
+    alert.estimate = syns;
+    alert.threshold = SYN_FLOOD_THRESHOLD;
+    return true;
+}
+
+AnomalyDetector::Source& AnomalyDetector::findSource(const FlowKey& key, uint64_t hash, int64_t nowMs)
+{
+    size_t first = (hash % (SOURCE_SLOTS / SOURCE_WAYS)) * SOURCE_WAYS;
+    size_t length = addressLength(key.ipVersion);
+    Source* victim = &sources[first];
+
+    for (size_t i = first; i < first + SOURCE_WAYS; i++)
+    {
+        Source& source = sources[i];
+        if (source.used && source.ipVersion == key.ipVersion && memcmp(source.addr, key.srcAddr, length) == 0)
+        {
+            return source;
+        }
+
+        // Prefere uma posição livre; senão, a origem vista há mais tempo
+        if (victim->used && (!source.used || source.lastSeenMs < victim->lastSeenMs))
+        {
+            victim = &source;
+        }
+    }
+
+    *victim = Source();
+    victim->used = true;
+    victim->ipVersion = key.ipVersion;
+    memcpy(victim->addr, key.srcAddr, sizeof(victim->addr));
+    victim->windowStartMs = nowMs;
+    return *victim;
+}
+
+bool AnomalyDetector::checkSource(const FlowKey& key, int64_t nowMs, Alert& alert)
+{
+    Source& source = findSource(key, hashAddress(key.ipVersion, key.srcAddr), nowMs);
+    source.lastSeenMs = nowMs;
+
+    if (nowMs - source.windowStartMs >= WINDOW_MS)
+    {
+        source.windowStartMs = nowMs;
+        source.ports.clear();
+        source.hosts.clear();
+        source.portScanReported = false;
+        source.fanOutReported = false;
+    }
+
+    uint64_t dstHash = hashAddress(key.ipVersion, key.dstAddr);
+    bool portsChanged = source.ports.add(mix(key.dstPort + 1));
+    bool hostsChanged = source.hosts.add(dstHash);
+
+    // A estimativa só sobe quando algum registrador muda
+    AlertKind kind = AlertKind::PortScan;
+    uint64_t estimate = 0;
+    uint64_t threshold = 0;
+    if (portsChanged && !source.portScanReported && (estimate = source.ports.estimate()) >= PORT_SCAN_THRESHOLD)
+    {
+        source.portScanReported = true;
+        kind = AlertKind::PortScan;
+        threshold = PORT_SCAN_THRESHOLD;
+    }
+    else if (hostsChanged && !source.fanOutReported && (estimate = source.hosts.estimate()) >= FAN_OUT_THRESHOLD)
+    {
+        source.fanOutReported = true;
+        kind = AlertKind::FanOut;
+        threshold = FAN_OUT_THRESHOLD;
+    }
+    else
+    {
+        return false;
+    }
+
+    alert.kind = kind;
+    alert.timestampMs = nowMs;
+    alert.ipVersion = key.ipVersion;
+    memcpy(alert.addr, key.srcAddr, sizeof(alert.addr));
+    alert.estimate = estimate;
+    alert.threshold = threshold;
+    return true;
+}
+
+// ===== EXPORTAÇÃO =====
+AlertLog& AlertLog::instance()
+{
+    static AlertLog log;
+    return log;
+}
+
+AlertLog::AlertLog()
+{
+    const char* path = getenv("PACKETSNIFFER_ALERTS_FILE");
+    if (path && *path)
+    {
+        file.open(path, ios::app);
+        if (!file)
+        {
+            cerr << "Não foi possível abrir o arquivo de alertas " << path << endl;
+        }
+    }
+}
+
+void AlertLog::write(const string& interface, const Alert& alert)
+{
+    lock_guard<mutex> lock(fileMutex);
+    if (file.is_open())
+    {
+        file << alert.toJson(interface) << "\n";
+        file.flush();
+    }
+}
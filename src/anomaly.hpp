@@ -0,0 +1,151 @@
+#ifndef ANOMALY_HPP
+#define ANOMALY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include "overload.hpp"
+
+enum class AlertKind
+{
+    SynFlood,   // Muitos SYN para um destino sem SYN-ACK correspondente (conexões meio abertas)
+    PortScan,   // Uma origem tocando muitas portas distintas
+    FanOut      // Uma origem contatando muitos hosts distintos
+};
+
+struct Alert
+{
+    AlertKind kind = AlertKind::SynFlood;
+    int64_t timestampMs = 0;       // Relógio do pcap
+    uint8_t ipVersion = 0;
+    uint8_t addr[16] = {};         // Destino atacado (SynFlood) ou origem suspeita
+    uint64_t estimate = 0;         // SYNs, portas ou hosts estimados na janela
+    uint64_t threshold = 0;
+
+    const char* kindName() const;
+    std::string addressString() const;
+
+    // Texto para a GUI, ex: "Varredura de portas a partir de 10.0.0.5: ~150 portas em 10 s"
+    std::string describe() const;
+
+    // Uma linha JSON (sem a quebra de linha final)
+    std::string toJson(const std::string& interface) const;
+};
+
+// Contador de cardinalidade HyperLogLog com 64 registradores (erro padrão ~13%)
+class HyperLogLog
+{
+    public:
+        static constexpr size_t REGISTERS = 64;
+
+        // Devolve true se algum registrador mudou (só então a estimativa pode ter subido)
+        bool add(uint64_t hash);
+        uint64_t estimate() const;
+        void clear() { registers.fill(0); }
+
+    private:
+        std::array<uint8_t, REGISTERS> registers{};
+};
+
+// Count-Min sketch com janela deslizante aproximada: duas gerações de contadores
+// (atual e anterior), com a anterior pesada pela fração da janela que ainda cobre
+class WindowedCountMin
+{
+    public:
+        static constexpr size_t DEPTH = 4;
+        static constexpr size_t WIDTH = 2048;
+
+        // Soma 1 à chave e devolve a estimativa da janela deslizante
+        uint64_t add(uint64_t hash, int64_t nowMs, int64_t windowMs);
+        uint64_t estimate(uint64_t hash, int64_t nowMs, int64_t windowMs);
+        void clear();
+
+    private:
+        void rotate(int64_t nowMs, int64_t windowMs);
+
+        std::array<std::array<uint32_t, WIDTH>, DEPTH> current{};
+        std::array<std::array<uint32_t, WIDTH>, DEPTH> previous{};
+        int64_t windowStartMs = 0;
+};
+
+// Detecção de varreduras e inundações sobre todos os pacotes de uma interface
+// (antes da amostragem). Usado só pela thread de captura, sem locks.
+//
+// A memória é fixa, independente de quantos endereços aparecem:
+//  - SYN flood: Count-Min de SYNs por destino e de SYN-ACKs por origem;
+//  - varredura de portas e fan-out: tabela de origens de SOURCE_SLOTS posições
+//    (associativa em conjuntos de SOURCE_WAYS) com dois HyperLogLog por origem,
+//    portas distintas e hosts distintos; com o conjunto cheio, a origem vista há
+//    mais tempo dá lugar à nova.
+// Cada alvo/origem gera no máximo um alerta de cada tipo por janela.
+class AnomalyDetector
+{
+    public:
+        static constexpr int64_t WINDOW_MS = 10000;
+        static constexpr uint64_t SYN_FLOOD_THRESHOLD = 1000;   // SYNs por janela para um destino
+        static constexpr uint64_t SYN_FLOOD_RATIO = 4;          // ... e ao menos 4 SYNs por SYN-ACK
+        static constexpr uint64_t PORT_SCAN_THRESHOLD = 100;    // Portas distintas por janela
+        static constexpr uint64_t FAN_OUT_THRESHOLD = 100;      // Hosts distintos por janela
+        static constexpr uint16_t SERVICE_PORT_LIMIT = 1024;    // Portas abaixo disso são de serviço
+
+        static constexpr size_t SOURCE_SLOTS = 1024;
+        static constexpr size_t SOURCE_WAYS = 4;
+        static constexpr size_t RECENT_TARGETS = 64;
+
+        // Analisa o pacote; devolve true (e preenche alert) quando um limite é cruzado
+        bool observe(const FlowKey& key, int64_t nowMs, Alert& alert);
+
+        void clear();
+
+    private:
+        struct Source
+        {
+            bool used = false;
+            uint8_t ipVersion = 0;
+            uint8_t addr[16] = {};
+            int64_t windowStartMs = 0;
+            int64_t lastSeenMs = 0;
+            bool portScanReported = false;
+            bool fanOutReported = false;
+            HyperLogLog ports;     // Portas de destino distintas (em qualquer host)
+            HyperLogLog hosts;     // Destinos distintos
+        };
+
+        // Destinos já alertados por SYN flood (evita um alerta por pacote durante o ataque)
+        struct RecentTarget
+        {
+            uint8_t ipVersion = 0;
+            uint8_t addr[16] = {};
+            int64_t alertedMs = 0;
+        };
+
+        WindowedCountMin synsByDestination;
+        WindowedCountMin synAcksBySource;
+        std::array<Source, SOURCE_SLOTS> sources;
+        std::array<RecentTarget, RECENT_TARGETS> recentTargets;
+        size_t nextRecentTarget = 0;
+
+        Source& findSource(const FlowKey& key, uint64_t hash, int64_t nowMs);
+        bool checkSynFlood(const FlowKey& key, int64_t nowMs, Alert& alert);
+        bool checkSource(const FlowKey& key, int64_t nowMs, Alert& alert);
+};
+
+// Exportação dos alertas em JSON Lines para PACKETSNIFFER_ALERTS_FILE (desativada sem a variável)
+class AlertLog
+{
+    public:
+        static AlertLog& instance();
+
+        void write(const std::string& interface, const Alert& alert);
+
+    private:
+        AlertLog();
+
+        std::mutex fileMutex;
+        std::ofstream file;
+};
+
+#endif
@@ -0,0 +1,461 @@
+#include "appdecoders.hpp"
+#include <cctype>
+
+using namespace std;
+
+static const uint8_t PROTO_TCP = 6;
+static const uint8_t PROTO_UDP = 17;
+
+static uint16_t read16(const uint8_t* p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t read24(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+}
+
+// Copia texto vindo da rede trocando bytes não imprimíveis por '?'
+template <size_t N>
+static void appendPrintable(FixedString<N>& out, const uint8_t* text, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        out.append(isprint(text[i]) ? static_cast<char>(text[i]) : '?');
+    }
+}
+
+void AppInfo::reset()
+{
+    protocol = AppProtocol::None;
+    response = false;
+    name.clear();
+    detail.clear();
+    addressCount = 0;
+}
+
+const char* AppInfo::protocolName() const
+{
+    switch (protocol)
+    {
+        case AppProtocol::DNS: return "DNS";
+        case AppProtocol::HTTP: return "HTTP";
+        case AppProtocol::TLS: return "TLS";
+        default: return "";
+    }
+}
+
+// ===== DISPATCH =====
+bool AppDecoder::isDnsServerReply(const FlowKey& key)
+{
+    return (key.protocol == PROTO_UDP && isDnsPort(key.srcPort)) || (key.protocol == PROTO_TCP && key.srcPort == 53);
+}
+
+bool AppDecoder::decode(const FlowKey& key, const uint8_t* data, uint32_t caplen, AppInfo& info)
+{
+    info.reset();
+    if (key.payloadLength == 0 || key.payloadOffset + key.payloadLength > caplen)
+    {
+        return false;
+    }
+
+    const uint8_t* payload = data + key.payloadOffset;
+    size_t length = key.payloadLength;
+
+    if (key.protocol == PROTO_UDP)
+    {
+        if (isDnsPort(key.srcPort) || isDnsPort(key.dstPort))
+        {
+            return decodeDns(payload, length, info);
+        }
+        return false;
+    }
+
+    if (key.protocol != PROTO_TCP)
+    {
+        return false;
+    }
+
+    // DNS sobre TCP: mensagem precedida por 2 bytes de tamanho
+    if ((key.srcPort == 53 || key.dstPort == 53) && length > 2)
+    {
+        size_t messageLength = min<size_t>(read16(payload), length - 2);
+        return decodeDns(payload + 2, messageLength, info);
+    }
+
+    // Segmentos no meio do fluxo não começam por um registro TLS nem por uma linha HTTP
+    if (payload[0] == 0x16)
+    {
+        return decodeTlsClientHello(payload, length, info);
+    }
+    return decodeHttp(payload, length, info);
+}
+
+// ===== DNS =====
+static const char* dnsTypeName(uint16_t type)
+{
+    switch (type)
+    {
+        case 1: return "A";
+        case 2: return "NS";
+        case 5: return "CNAME";
+        case 6: return "SOA";
+        case 12: return "PTR";
+        case 15: return "MX";
+        case 16: return "TXT";
+        case 28: return "AAAA";
+        case 33: return "SRV";
+        case 65: return "HTTPS";
+        case 255: return "ANY";
+        default: return "?";
+    }
+}
+
+// Lê um nome a partir de pos (seguindo ponteiros de compressão) e avança pos até o fim dele.
+// Com out == nullptr o nome só é pulado.
+static bool readDnsName(const uint8_t* msg, size_t length, size_t& pos, FixedString<AppInfo::MAX_NAME>* out)
+{
+    static const int MAX_JUMPS = 16;
+
+    size_t cursor = pos;
+    bool jumped = false;
+    int jumps = 0;
+
+    while (cursor < length)
+    {
+        uint8_t labelLength = msg[cursor];
+
+        if ((labelLength & 0xC0) == 0xC0)
+        {
+            if (cursor + 1 >= length || ++jumps > MAX_JUMPS)
+            {
+                return false;
+            }
+            if (!jumped)
+            {
+                pos = cursor + 2;
+                jumped = true;
+            }
+            cursor = (static_cast<size_t>(labelLength & 0x3F) << 8) | msg[cursor + 1];
+            continue;
+        }
+        if (labelLength & 0xC0)
+        {
+            return false; // Tipos de rótulo estendidos não são suportados
+        }
+
+        if (labelLength == 0)
+        {
+            if (!jumped)
+            {
+                pos = cursor + 1;
+            }
+            return true;
+        }
+
+        if (cursor + 1 + labelLength > length)
+        {
+            return false;
+        }
+        if (out)
+        {
+            if (!out->empty())
+            {
+                out->append('.');
+            }
+            appendPrintable(*out, msg + cursor + 1, labelLength);
+        }
+        cursor += 1 + labelLength;
+    }
+
+    return false;
+}
+
+bool AppDecoder::decodeDns(const uint8_t* msg, size_t length, AppInfo& info)
+{
+    static const size_t HEADER_LEN = 12;
+    if (length < HEADER_LEN)
+    {
+        return false;
+    }
+
+    uint16_t flags = read16(msg + 2);
+    uint16_t questions = read16(msg + 4);
+    uint16_t answers = read16(msg + 6);
+    bool response = (flags & 0x8000) != 0;
+
+    // Só opcode 0. Consultas têm ao menos uma pergunta; respostas mDNS não têm nenhuma (RFC 6762 §6)
+    if (((flags >> 11) & 0x0F) != 0 || (questions == 0 && !response))
+    {
+        return false;
+    }
+
+    size_t pos = HEADER_LEN;
+    uint16_t queryType = 0;
+    for (uint16_t q = 0; q < questions; q++)
+    {
+        if (!readDnsName(msg, length, pos, q == 0 ? &info.name : nullptr) || pos + 4 > length)
+        {
+            return false;
+        }
+        if (q == 0)
+        {
+            queryType = read16(msg + pos);
+        }
+        pos += 4;
+    }
+
+    info.protocol = AppProtocol::DNS;
+    info.response = response;
+    info.detail.append(info.response ? "resposta" : "consulta");
+    if (questions > 0)
+    {
+        info.detail.append(' ');
+        info.detail.append(dnsTypeName(queryType), strlen(dnsTypeName(queryType)));
+    }
+
+    if (!info.response)
+    {
+        return true;
+    }
+
+    uint8_t rcode = flags & 0x0F;
+    if (rcode == 3)
+    {
+        info.detail.append(" NXDOMAIN");
+        return true;
+    }
+    if (rcode != 0)
+    {
+        info.detail.append(" erro");
+        return true;
+    }
+
+    // Registros A/AAAA da seção de respostas, cada um com o próprio nome de dono.
+    // No mDNS o bit mais alto da classe é o "cache flush" e não faz parte dela.
+    for (uint16_t a = 0; a < answers && info.addressCount < AppInfo::MAX_DNS_ADDRESSES; a++)
+    {
+        DnsAddress& address = info.addresses[info.addressCount];
+        address.name.clear();
+        if (!readDnsName(msg, length, pos, &address.name) || pos + 10 > length)
+        {
+            break;
+        }
+        uint16_t type = read16(msg + pos);
+        uint16_t recordClass = read16(msg + pos + 2) & 0x7FFF;
+        uint16_t dataLength = read16(msg + pos + 8);
+        pos += 10;
+        if (pos + dataLength > length)
+        {
+            break;
+        }
+
+        if (recordClass == 1 && type == 1 && dataLength == 4)
+        {
+            address.ipVersion = 4;
+            memcpy(address.addr, msg + pos, 4);
+            memset(address.addr + 4, 0, 12);
+            info.addressCount++;
+        }
+        else if (recordClass == 1 && type == 28 && dataLength == 16)
+        {
+            address.ipVersion = 6;
+            memcpy(address.addr, msg + pos, 16);
+            info.addressCount++;
+        }
+        pos += dataLength;
+    }
+
+    // Anúncio sem perguntas: a coluna Info mostra o nome do primeiro endereço anunciado
+    if (questions == 0 && info.addressCount > 0)
+    {
+        info.name.append(info.addresses[0].name.view());
+    }
+
+    return true;
+}
+
+// ===== HTTP/1.x =====
+static bool startsWith(const uint8_t* data, size_t length, string_view prefix)
+{
+    return length >= prefix.size() && memcmp(data, prefix.data(), prefix.size()) == 0;
+}
+
+static size_t findLineEnd(const uint8_t* data, size_t start, size_t length)
+{
+    for (size_t i = start; i + 1 < length; i++)
+    {
+        if (data[i] == '\r' && data[i + 1] == '\n')
+        {
+            return i;
+        }
+    }
+    return length;
+}
+
+bool AppDecoder::decodeHttp(const uint8_t* data, size_t length, AppInfo& info)
+{
+    static const string_view METHODS[] = {
+        "GET ", "POST ", "PUT ", "DELETE ", "HEAD ", "OPTIONS ", "PATCH ", "CONNECT "
+    };
+    static const string_view VERSION_PREFIX = "HTTP/1.";
+
+    size_t lineEnd = findLineEnd(data, 0, length);
+
+    // Resposta: "HTTP/1.1 200 OK"
+    if (startsWith(data, length, VERSION_PREFIX))
+    {
+        size_t statusStart = VERSION_PREFIX.size() + 2; // Dígito da versão e espaço
+        if (statusStart >= lineEnd)
+        {
+            return false;
+        }
+        info.protocol = AppProtocol::HTTP;
+        info.response = true;
+        appendPrintable(info.detail, data + statusStart, lineEnd - statusStart);
+        return true;
+    }
+
+    bool isRequest = false;
+    for (string_view method : METHODS)
+    {
+        if (startsWith(data, length, method))
+        {
+            isRequest = true;
+            break;
+        }
+    }
+    if (!isRequest)
+    {
+        return false;
+    }
+
+    // Linha de requisição sem a versão no final: "GET /caminho"
+    size_t requestEnd = lineEnd;
+    if (requestEnd >= VERSION_PREFIX.size() + 2 &&
+        memcmp(data + requestEnd - VERSION_PREFIX.size() - 1, VERSION_PREFIX.data(), VERSION_PREFIX.size()) == 0)
+    {
+        requestEnd -= VERSION_PREFIX.size() + 2; // " HTTP/1.x"
+    }
+
+    info.protocol = AppProtocol::HTTP;
+    info.response = false;
+    appendPrintable(info.detail, data, requestEnd);
+
+    // Cabeçalho Host, até o fim dos cabeçalhos ou do que foi capturado
+    static const string_view HOST = "host:";
+    size_t lineStart = lineEnd + 2;
+    while (lineStart < length)
+    {
+        size_t end = findLineEnd(data, lineStart, length);
+        if (end == lineStart)
+        {
+            break; // Linha vazia: fim dos cabeçalhos
+        }
+
+        if (end - lineStart > HOST.size())
+        {
+            bool match = true;
+            for (size_t i = 0; i < HOST.size() && match; i++)
+            {
+                match = tolower(data[lineStart + i]) == HOST[i];
+            }
+            if (match)
+            {
+                size_t valueStart = lineStart + HOST.size();
+                while (valueStart < end && (data[valueStart] == ' ' || data[valueStart] == '\t'))
+                {
+                    valueStart++;
+                }
+                appendPrintable(info.name, data + valueStart, end - valueStart);
+                break;
+            }
+        }
+        lineStart = end + 2;
+    }
+
+    return true;
+}
+
+// ===== TLS CLIENTHELLO (SNI) =====
+bool AppDecoder::decodeTlsClientHello(const uint8_t* data, size_t length, AppInfo& info)
+{
+    static const size_t RECORD_HEADER_LEN = 5;
+    static const size_t HANDSHAKE_HEADER_LEN = 4;
+    static const uint16_t EXT_SERVER_NAME = 0;
+
+    // Registro handshake (0x16), versão 3.x, mensagem ClientHello (1)
+    if (length < RECORD_HEADER_LEN + HANDSHAKE_HEADER_LEN || data[0] != 0x16 || data[1] != 0x03 ||
+        data[RECORD_HEADER_LEN] != 0x01)
+    {
+        return false;
+    }
+
+    size_t end = min(length, RECORD_HEADER_LEN + read16(data + 3));
+    end = min(end, RECORD_HEADER_LEN + HANDSHAKE_HEADER_LEN + read24(data + RECORD_HEADER_LEN + 1));
+
+    info.protocol = AppProtocol::TLS;
+    info.response = false;
+    info.detail.append("ClientHello");
+
+    // Versão (2) + random (32), depois os campos de tamanho variável
+    size_t pos = RECORD_HEADER_LEN + HANDSHAKE_HEADER_LEN + 34;
+    if (pos + 1 > end)
+    {
+        return true;
+    }
+    pos += 1 + data[pos];                   // Session ID
+    if (pos + 2 > end)
+    {
+        return true;
+    }
+    pos += 2 + read16(data + pos);          // Cipher suites
+    if (pos + 1 > end)
+    {
+        return true;
+    }
+    pos += 1 + data[pos];                   // Métodos de compressão
+    if (pos + 2 > end)
+    {
+        return true;
+    }
+
+    size_t extensionsEnd = min(end, pos + 2 + read16(data + pos));
+    pos += 2;
+
+    while (pos + 4 <= extensionsEnd)
+    {
+        uint16_t type = read16(data + pos);
+        uint16_t extensionLength = read16(data + pos + 2);
+        pos += 4;
+
+        if (type == EXT_SERVER_NAME && pos + 2 <= extensionsEnd)
+        {
+            // server_name_list: tipo (1) + tamanho (2) + nome
+            size_t listEnd = min(extensionsEnd, pos + 2 + read16(data + pos));
+            size_t entry = pos + 2;
+            while (entry + 3 <= listEnd)
+            {
+                uint8_t nameType = data[entry];
+                uint16_t nameLength = read16(data + entry + 1);
+                entry += 3;
+                if (entry + nameLength > listEnd)
+                {
+                    break;
+                }
+                if (nameType == 0)
+                {
+                    appendPrintable(info.name, data + entry, nameLength);
+                    return true;
+                }
+                entry += nameLength;
+            }
+            return true;
+        }
+
+        pos += extensionLength;
+    }
+
+    return true;
+}
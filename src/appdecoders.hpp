@@ -0,0 +1,94 @@
+#ifndef APPDECODERS_HPP
+#define APPDECODERS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "overload.hpp"
+
+// Texto de capacidade fixa, preenchido sem alocação no caminho quente
+template <size_t N>
+struct FixedString
+{
+    char data[N];
+    size_t size = 0;
+
+    void clear() { size = 0; }
+    bool empty() const { return size == 0; }
+    std::string_view view() const { return std::string_view(data, size); }
+
+    void append(const char* text, size_t length)
+    {
+        length = std::min(length, N - size);
+        memcpy(data + size, text, length);
+        size += length;
+    }
+    void append(std::string_view text) { append(text.data(), text.size()); }
+    void append(char c)
+    {
+        if (size < N)
+        {
+            data[size++] = c;
+        }
+    }
+};
+
+// Protocolos de aplicação reconhecidos
+enum class AppProtocol : uint8_t
+{
+    None = 0,
+    DNS,
+    HTTP,
+    TLS
+};
+
+// Endereço devolvido em uma resposta DNS (registros A e AAAA)
+struct DnsAddress
+{
+    static constexpr size_t MAX_NAME = 253;
+
+    uint8_t ipVersion = 0;  // 4 ou 6
+    uint8_t addr[16] = {};
+    FixedString<MAX_NAME> name;  // Dono do registro (em cadeias CNAME, o alvo final, não o consultado)
+};
+
+// Resultado da decodificação de aplicação de um pacote
+struct AppInfo
+{
+    static constexpr size_t MAX_NAME = DnsAddress::MAX_NAME;  // Nome DNS mais longo permitido
+    static constexpr size_t MAX_DETAIL = 96;
+    static constexpr size_t MAX_DNS_ADDRESSES = 8;
+
+    AppProtocol protocol = AppProtocol::None;
+    bool response = false;
+    FixedString<MAX_NAME> name;      // Nome consultado (DNS), Host (HTTP) ou SNI (TLS)
+    FixedString<MAX_DETAIL> detail;  // Ex: "consulta AAAA", "GET /index.html", "200 OK"
+
+    DnsAddress addresses[MAX_DNS_ADDRESSES];
+    size_t addressCount = 0;
+
+    void reset();
+    const char* protocolName() const;
+};
+
+// Decodificadores leves de DNS, HTTP/1.x e TLS ClientHello.
+// Trabalham direto sobre os bytes capturados, com verificação de limites e sem alocação.
+class AppDecoder
+{
+    public:
+        // Escolhe o decodificador pelas portas e pelo conteúdo do payload de transporte
+        static bool decode(const FlowKey& key, const uint8_t* data, uint32_t caplen, AppInfo& info);
+
+        static bool decodeDns(const uint8_t* payload, size_t length, AppInfo& info);
+        static bool decodeHttp(const uint8_t* payload, size_t length, AppInfo& info);
+        static bool decodeTlsClientHello(const uint8_t* payload, size_t length, AppInfo& info);
+
+        static bool isDnsPort(uint16_t port) { return port == 53 || port == 5353; }
+
+        // Pacote vindo de um servidor DNS (UDP 53/5353 ou TCP 53), que pode trazer respostas
+        static bool isDnsServerReply(const FlowKey& key);
+};
+
+#endif
@@ -0,0 +1,324 @@
+#include "defrag.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+static const size_t ETHERNET_HEADER_LEN = 14;
+static const size_t IPV6_HEADER_LEN = 40;
+
+atomic<size_t> Defragmenter::bytesInUse{0};
+
+Defragmenter::Defragmenter(InterfaceMetrics* m) : metrics(m)
+{
+}
+
+Defragmenter::~Defragmenter()
+{
+    clear();
+}
+
+size_t Defragmenter::memoryBudget()
+{
+    static const size_t budget = []() {
+        size_t megabytes = DEFAULT_BUDGET_MB;
+        const char* value = getenv("PACKETSNIFFER_DEFRAG_BUDGET_MB");
+        if (value && *value)
+        {
+            char* end = nullptr;
+            long parsed = strtol(value, &end, 10);
+            if (end && *end == '\0' && parsed > 0)
+            {
+                megabytes = static_cast<size_t>(parsed);
+            }
+        }
+        return megabytes * 1024 * 1024;
+    }();
+    return budget;
+}
+
+void Defragmenter::clear()
+{
+    for (Datagram& datagram : table)
+    {
+        if (datagram.used)
+        {
+            release(datagram);
+        }
+    }
+}
+
+// ===== TABELA =====
+Defragmenter::Datagram* Defragmenter::oldest(const Datagram* except)
+{
+    Datagram* victim = nullptr;
+    for (Datagram& datagram : table)
+    {
+        if (datagram.used && &datagram != except && (!victim || datagram.firstSeenMs < victim->firstSeenMs))
+        {
+            victim = &datagram;
+        }
+    }
+    return victim;
+}
+
+Defragmenter::Datagram* Defragmenter::find(const FlowKey& key, int64_t nowMs)
+{
+    Datagram* freeSlot = nullptr;
+
+    for (Datagram& datagram : table)
+    {
+        if (!datagram.used)
+        {
+            if (!freeSlot)
+            {
+                freeSlot = &datagram;
+            }
+            continue;
+        }
+
+        if (datagram.id == key.fragmentId && datagram.ipVersion == key.ipVersion &&
+            datagram.protocol == key.protocol &&
+            memcmp(datagram.srcAddr, key.srcAddr, sizeof(key.srcAddr)) == 0 &&
+            memcmp(datagram.dstAddr, key.dstAddr, sizeof(key.dstAddr)) == 0)
+        {
+            return &datagram;
+        }
+    }
+
+    // Tabela cheia: o datagrama incompleto mais antigo dá lugar ao novo
+    if (!freeSlot)
+    {
+        freeSlot = oldest(nullptr);
+        release(*freeSlot);
+        metrics->reassemblyEvictions.fetch_add(1, memory_order_relaxed);
+    }
+
+    Datagram& datagram = *freeSlot;
+    datagram.used = true;
+    datagram.ipVersion = key.ipVersion;
+    datagram.protocol = key.protocol;
+    memcpy(datagram.srcAddr, key.srcAddr, sizeof(key.srcAddr));
+    memcpy(datagram.dstAddr, key.dstAddr, sizeof(key.dstAddr));
+    datagram.id = key.fragmentId;
+    datagram.firstSeenMs = nowMs;
+    return &datagram;
+}
+
+// ===== ORÇAMENTO =====
+bool Defragmenter::reserve(Datagram& datagram, size_t bytes)
+{
+    size_t budget = memoryBudget();
+    while (true)
+    {
+        size_t previous = bytesInUse.fetch_add(bytes, memory_order_relaxed);
+        if (previous + bytes <= budget)
+        {
+            datagram.reserved += bytes;
+            return true;
+        }
+        bytesInUse.fetch_sub(bytes, memory_order_relaxed);
+
+        // Libera o datagrama mais antigo desta interface e tenta de novo
+        Datagram* victim = oldest(&datagram);
+        if (!victim)
+        {
+            return false;
+        }
+        release(*victim);
+        metrics->reassemblyEvictions.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Defragmenter::release(Datagram& datagram)
+{
+    bytesInUse.fetch_sub(datagram.reserved, memory_order_relaxed);
+    datagram.reserved = 0;
+    datagram.used = false;
+    datagram.totalLength = 0;
+    datagram.pieceCount = 0;
+    datagram.nextHeaderFieldOffset = 0;
+
+    // Devolve de fato a memória, para que o orçamento reflita o uso real
+    vector<uint8_t>().swap(datagram.header);
+    vector<uint8_t>().swap(datagram.payload);
+}
+
+// ===== INTERVALOS RECEBIDOS =====
+bool Defragmenter::addPiece(Datagram& datagram, uint32_t start, uint32_t end)
+{
+    auto& pieces = datagram.pieces;
+    size_t count = datagram.pieceCount;
+
+    // Intervalos ordenados e disjuntos; o novo absorve os que toca ou sobrepõe
+    size_t first = 0;
+    while (first < count && pieces[first].end < start)
+    {
+        first++;
+    }
+
+    Piece merged{start, end};
+    size_t last = first;
+    while (last < count && pieces[last].start <= end)
+    {
+        merged.start = min(merged.start, pieces[last].start);
+        merged.end = max(merged.end, pieces[last].end);
+        last++;
+    }
+
+    size_t absorbed = last - first;
+    if (absorbed == 0)
+    {
+        if (count == MAX_PIECES)
+        {
+            return false;
+        }
+        move_backward(pieces.begin() + first, pieces.begin() + count, pieces.begin() + count + 1);
+        pieces[first] = merged;
+        datagram.pieceCount++;
+    }
+    else
+    {
+        pieces[first] = merged;
+        move(pieces.begin() + last, pieces.begin() + count, pieces.begin() + first + 1);
+        datagram.pieceCount -= absorbed - 1;
+    }
+    return true;
+}
+
+bool Defragmenter::complete(const Datagram& datagram) const
+{
+    return datagram.totalLength != 0 && !datagram.header.empty() && datagram.pieceCount == 1 &&
+           datagram.pieces[0].start == 0 && datagram.pieces[0].end == datagram.totalLength;
+}
+
+// ===== REMONTAGEM =====
+void Defragmenter::assemble(const Datagram& datagram, vector<uint8_t>& frame) const
+{
+    frame.assign(datagram.header.begin(), datagram.header.end());
+    frame.insert(frame.end(), datagram.payload.begin(), datagram.payload.begin() + datagram.totalLength);
+    uint8_t* ip = frame.data() + ETHERNET_HEADER_LEN;
+
+    if (datagram.ipVersion == 4)
+    {
+        size_t headerLen = datagram.header.size() - ETHERNET_HEADER_LEN;
+        size_t totalLength = headerLen + datagram.totalLength;
+        ip[2] = static_cast<uint8_t>(totalLength >> 8);
+        ip[3] = static_cast<uint8_t>(totalLength);
+        ip[6] = 0;  // Sem MF e com offset zero
+        ip[7] = 0;
+
+        // Checksum do cabeçalho recalculado
+        ip[10] = 0;
+        ip[11] = 0;
+        uint32_t sum = 0;
+        for (size_t i = 0; i + 1 < headerLen; i += 2)
+        {
+            sum += static_cast<uint32_t>((ip[i] << 8) | ip[i + 1]);
+        }
+        while (sum >> 16)
+        {
+            sum = (sum & 0xFFFF) + (sum >> 16);
+        }
+        uint16_t checksum = static_cast<uint16_t>(~sum);
+        ip[10] = static_cast<uint8_t>(checksum >> 8);
+        ip[11] = static_cast<uint8_t>(checksum);
+    }
+    else
+    {
+        // O cabeçalho de fragmento some: quem apontava para ele passa a apontar para o transporte
+        frame[datagram.nextHeaderFieldOffset] = datagram.protocol;
+        size_t payloadLength = datagram.header.size() - ETHERNET_HEADER_LEN - IPV6_HEADER_LEN + datagram.totalLength;
+        ip[4] = static_cast<uint8_t>(payloadLength >> 8);
+        ip[5] = static_cast<uint8_t>(payloadLength);
+    }
+}
+
+bool Defragmenter::add(const FlowKey& key, const uint8_t* data, uint32_t caplen, int64_t nowMs, vector<uint8_t>& frame)
+{
+    metrics->fragmentsReceived.fetch_add(1, memory_order_relaxed);
+
+    uint32_t start = key.fragmentOffset;
+    uint32_t end = start + key.fragmentDataLength;
+    uint32_t headerLen = key.unfragmentableLength - ETHERNET_HEADER_LEN;
+
+    // Fragmentos vazios, cortados pela captura (o cabeçalho IP anuncia mais bytes do que o quadro
+    // tem) ou que ultrapassam o tamanho máximo de um datagrama
+    if (key.fragmentDataLength == 0 || key.fragmentDataOffset + key.fragmentDataLength > caplen ||
+        end + (key.ipVersion == 4 ? headerLen : headerLen - IPV6_HEADER_LEN) > MAX_PAYLOAD)
+    {
+        metrics->reassemblyEvictions.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    Datagram& datagram = *find(key, nowMs);
+
+    // O último fragmento define o tamanho; fragmentos incoerentes descartam o datagrama
+    bool inconsistent = (!key.moreFragments && datagram.totalLength != 0 && datagram.totalLength != end) ||
+                        (datagram.totalLength != 0 && end > datagram.totalLength);
+    if (inconsistent)
+    {
+        release(datagram);
+        metrics->reassemblyEvictions.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    if (!key.moreFragments)
+    {
+        datagram.totalLength = end;
+    }
+
+    // O orçamento é descontado pela capacidade real dos buffers depois de crescerem
+    // (resize pode reservar mais do que o pedido)
+    size_t capacityBefore = datagram.header.capacity() + datagram.payload.capacity();
+
+    if (start == 0 && datagram.header.empty())
+    {
+        datagram.header.assign(data, data + key.unfragmentableLength);
+        datagram.nextHeaderFieldOffset = key.nextHeaderFieldOffset;
+    }
+    if (end > datagram.payload.size())
+    {
+        datagram.payload.resize(end);
+    }
+
+    size_t capacityAfter = datagram.header.capacity() + datagram.payload.capacity();
+    if (capacityAfter > capacityBefore && !reserve(datagram, capacityAfter - capacityBefore))
+    {
+        release(datagram);
+        metrics->reassemblyEvictions.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    // Sobreposições: os bytes do fragmento mais recente prevalecem
+    memcpy(datagram.payload.data() + start, data + key.fragmentDataOffset, key.fragmentDataLength);
+
+    if (!addPiece(datagram, start, end))
+    {
+        release(datagram);
+        metrics->reassemblyEvictions.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    if (!complete(datagram))
+    {
+        return false;
+    }
+
+    assemble(datagram, frame);
+    release(datagram);
+    metrics->datagramsReassembled.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+void Defragmenter::expire(int64_t nowMs)
+{
+    for (Datagram& datagram : table)
+    {
+        if (datagram.used && nowMs - datagram.firstSeenMs > TIMEOUT_MS)
+        {
+            release(datagram);
+            metrics->reassemblyTimeouts.fetch_add(1, memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef DEFRAG_HPP
+#define DEFRAG_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "metrics.hpp"
+#include "overload.hpp"
+
+// Remontagem de datagramas IPv4/IPv6 fragmentados.
+//
+// Cada Sniffer tem o seu Defragmenter (usado só pela thread de captura, sem locks),
+// com uma tabela de tamanho fixo de datagramas em remontagem. Os buffers são alocados
+// sob demanda e descontados de um orçamento de memória global, compartilhado por todas
+// as interfaces; sem espaço, o datagrama mais antigo da tabela é descartado.
+// Datagramas incompletos expiram após TIMEOUT_MS (relógio monotônico do chamador).
+class Defragmenter
+{
+    public:
+        static constexpr size_t TABLE_SIZE = 256;          // Datagramas em remontagem por interface
+        static constexpr size_t MAX_PIECES = 64;           // Intervalos disjuntos por datagrama
+        static constexpr uint32_t MAX_PAYLOAD = 65535;
+        static constexpr int64_t TIMEOUT_MS = 30000;
+        static constexpr size_t DEFAULT_BUDGET_MB = 32;
+
+        explicit Defragmenter(InterfaceMetrics* metrics);
+        ~Defragmenter();
+
+        Defragmenter(const Defragmenter&) = delete;
+        Defragmenter& operator=(const Defragmenter&) = delete;
+
+        // Recebe um fragmento. Quando o datagrama fica completo, o quadro remontado
+        // (Ethernet + IP sem fragmentação + dados) é escrito em frame e a função devolve true.
+        bool add(const FlowKey& key, const uint8_t* data, uint32_t caplen, int64_t nowMs, std::vector<uint8_t>& frame);
+
+        // Descarta datagramas incompletos mais antigos que TIMEOUT_MS
+        void expire(int64_t nowMs);
+
+        void clear();
+
+        // Troca a interface de destino dos contadores (Sniffer reaproveitado em outro dispositivo)
+        void setMetrics(InterfaceMetrics* m) { metrics = m; }
+
+        // Orçamento global, lido de PACKETSNIFFER_DEFRAG_BUDGET_MB
+        static size_t memoryBudget();
+        static size_t memoryInUse() { return bytesInUse.load(std::memory_order_relaxed); }
+
+    private:
+        struct Piece
+        {
+            uint32_t start;
+            uint32_t end;
+        };
+
+        struct Datagram
+        {
+            bool used = false;
+            uint8_t ipVersion = 0;
+            uint8_t protocol = 0;
+            uint8_t srcAddr[16] = {};
+            uint8_t dstAddr[16] = {};
+            uint32_t id = 0;
+            int64_t firstSeenMs = 0;
+
+            uint32_t totalLength = 0;          // Conhecido ao receber o último fragmento (sem MF)
+            std::array<Piece, MAX_PIECES> pieces;
+            size_t pieceCount = 0;
+
+            std::vector<uint8_t> header;       // Ethernet + cabeçalhos do fragmento de offset 0
+            uint16_t nextHeaderFieldOffset = 0;
+            std::vector<uint8_t> payload;
+            size_t reserved = 0;               // Bytes descontados do orçamento global
+        };
+
+        InterfaceMetrics* metrics;
+        std::array<Datagram, TABLE_SIZE> table;
+
+        static std::atomic<size_t> bytesInUse;
+
+        Datagram* find(const FlowKey& key, int64_t nowMs);
+        Datagram* oldest(const Datagram* except);
+        bool reserve(Datagram& datagram, size_t bytes);
+        void release(Datagram& datagram);
+        bool addPiece(Datagram& datagram, uint32_t start, uint32_t end);
+        bool complete(const Datagram& datagram) const;
+        void assemble(const Datagram& datagram, std::vector<uint8_t>& frame) const;
+};
+
+#endif
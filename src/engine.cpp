@@ -0,0 +1,241 @@
+#include "engine.hpp"
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+CaptureEngine::CaptureEngine(QObject *parent) : QObject(parent)
+{
+    // CapturedRow atravessa threads em conexões enfileiradas
+    qRegisterMetaType<CapturedRow>("CapturedRow");
+    qRegisterMetaType<Alert>("Alert");
+
+    // Sem fontes, a thread de merge fica bloqueada até a primeira captura
+    merger.start();
+}
+
+CaptureEngine::~CaptureEngine()
+{
+    stop();
+    merger.stop();
+}
+
+vector<string> CaptureEngine::getDevices() const
+{
+    vector<string> devices;
+    for (const auto& sniffer : sniffers)
+    {
+        devices.push_back(sniffer->getDeviceName());
+    }
+    return devices;
+}
+
+// Reaproveita um Sniffer já aberto no mesmo dispositivo; senão um ocioso, senão cria um novo
+unique_ptr<Sniffer> CaptureEngine::takeSniffer(const string& device, uint8_t index)
+{
+    auto sameDevice = [&device](const unique_ptr<Sniffer>& sniffer) { return sniffer->getDeviceName() == device; };
+
+    auto it = find_if(idleSniffers.begin(), idleSniffers.end(), sameDevice);
+    if (it == idleSniffers.end())
+    {
+        it = find_if(idleSniffers.begin(), idleSniffers.end(),
+                     [](const unique_ptr<Sniffer>& sniffer) { return sniffer->getState() == CaptureState::Idle; });
+    }
+
+    unique_ptr<Sniffer> sniffer;
+    if (it != idleSniffers.end())
+    {
+        sniffer = move(*it);
+        idleSniffers.erase(it);
+    }
+    else
+    {
+        sniffer = make_unique<Sniffer>(device, index);
+
+        // O Sniffer pode mudar de dispositivo: o nome é lido na hora do sinal
+        Sniffer* source = sniffer.get();
+        QObject::connect(source, &Sniffer::samplingRateChanged, this, [this, source](int rate) {
+            emit samplingRateChanged(QString::fromStdString(source->getDeviceName()), rate);
+        });
+        QObject::connect(source, &Sniffer::anomalyDetected, this, [this, source](Alert alert) {
+            emit anomalyDetected(QString::fromStdString(source->getDeviceName()), alert);
+        });
+        QObject::connect(source, &Sniffer::captureError, this, [this, source](QString message) {
+            handleCaptureError(source, message);
+        });
+    }
+
+    if (sniffer->getDeviceName() != device)
+    {
+        sniffer->close();
+    }
+    sniffer->setDevice(device, index);
+    return sniffer;
+}
+
+// ===== ERRO DE CAPTURA =====
+// Chega pela fila do Qt: a interface com erro já está em Paused. A captura inteira é pausada,
+// para que o motor e a GUI voltem a um estado coerente, e a interface é fechada; um novo
+// start a reabre.
+void CaptureEngine::handleCaptureError(Sniffer* source, const QString& message)
+{
+    auto it = find_if(sniffers.begin(), sniffers.end(),
+                      [source](const unique_ptr<Sniffer>& sniffer) { return sniffer.get() == source; });
+    if (it == sniffers.end())
+    {
+        return; // Já saiu da captura
+    }
+
+    pause();
+    source->close();
+    emit captureError(QString::fromStdString(source->getDeviceName()), message);
+}
+
+void CaptureEngine::pauseSniffers()
+{
+    for (auto& sniffer : sniffers)
+    {
+        sniffer->pause();
+    }
+}
+
+bool CaptureEngine::start(const vector<string>& devices)
+{
+    if (state == CaptureState::Running)
+    {
+        pause();
+    }
+
+    // Os atuais voltam para o conjunto de reuso; o merge entrega o que ainda está nas filas
+    merger.flush();
+    for (auto& sniffer : sniffers)
+    {
+        idleSniffers.push_back(move(sniffer));
+    }
+    sniffers.clear();
+    interfaceNames.clear();
+
+    for (const string& device : devices)
+    {
+        uint8_t index = static_cast<uint8_t>(sniffers.size());
+        auto sniffer = takeSniffer(device, index);
+        sniffer->setPatternMatcher(patternMatcher);
+
+        string error;
+        if (!sniffer->setFilter(filterExpression, error) || !sniffer->open(error))
+        {
+            cerr << "Interface " << device << " ignorada: " << error << endl;
+            sniffer->close();
+            idleSniffers.push_back(move(sniffer));
+            continue;
+        }
+
+        interfaceNames.push_back(QString::fromStdString(device));
+        sniffers.push_back(move(sniffer));
+    }
+
+    // Dispositivos que saíram da captura são fechados; threads e filas ficam para o próximo uso
+    for (auto& sniffer : idleSniffers)
+    {
+        sniffer->close();
+    }
+
+    vector<SpscRing<CapturedRow>*> rings;
+    for (auto& sniffer : sniffers)
+    {
+        rings.push_back(&sniffer->getRing());
+    }
+
+    // O handler roda na thread de merge; o Qt enfileira o sinal para a GUI.
+    // Os nomes são copiados para que uma troca de interfaces não mexa no vetor em uso.
+    vector<QString> names = interfaceNames;
+    merger.setSources(rings, [this, names](size_t source, CapturedRow& row) {
+        Metrics::instance().queuePushed();
+        StageTimer<Stage::EmitSignal> timer;
+        emit packetCaptured(names[source], row);
+    });
+
+    if (sniffers.empty())
+    {
+        state = CaptureState::Idle;
+        return false;
+    }
+
+    state = CaptureState::Paused;
+    resume();
+    return true;
+}
+
+void CaptureEngine::pause()
+{
+    if (state != CaptureState::Running)
+    {
+        return;
+    }
+
+    pauseSniffers();
+    state = CaptureState::Paused;
+
+    if constexpr (PROFILING_ENABLED)
+    {
+        Profiler::instance().endSession();
+    }
+}
+
+void CaptureEngine::resume()
+{
+    if (state != CaptureState::Paused)
+    {
+        return;
+    }
+
+    if constexpr (PROFILING_ENABLED)
+    {
+        Profiler::instance().beginSession();
+    }
+
+    for (auto& sniffer : sniffers)
+    {
+        sniffer->resume();
+    }
+    state = CaptureState::Running;
+}
+
+void CaptureEngine::stop()
+{
+    if (state == CaptureState::Idle)
+    {
+        return;
+    }
+
+    pause();
+
+    // Nenhum produtor ativo: tudo o que já foi capturado chega à GUI, em ordem
+    state = CaptureState::Draining;
+    merger.flush();
+
+    for (auto& sniffer : sniffers)
+    {
+        sniffer->close();
+    }
+    state = CaptureState::Idle;
+}
+
+bool CaptureEngine::setFilter(const string& expression, string& error)
+{
+    // Expressão inválida não chega a pausar nenhuma interface
+    if (!Sniffer::validateFilter(expression, error))
+    {
+        return false;
+    }
+
+    bool applied = true;
+    for (auto& sniffer : sniffers)
+    {
+        applied = sniffer->setFilter(expression, error) && applied;
+    }
+
+    // Sem captura aberta, o filtro vale a partir do próximo start
+    filterExpression = expression;
+    return applied;
+}
@@ -0,0 +1,75 @@
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include "sniffer.hpp"
+#include "merger.hpp"
+#include <QObject>
+#include <QString>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Captura simultânea em várias interfaces: um Sniffer (thread + fila) por
+// interface e um único merge ordenado por timestamp alimentando a GUI.
+//
+// O motor vive tanto quanto a janela. Sniffers, threads e filas são reaproveitados
+// entre capturas: pausar e retomar não reabre nada, e trocar de interfaces só reabre
+// os handles pcap dos dispositivos que mudaram.
+//
+// Idle -start-> Running -pause-> Paused -resume-> Running
+// Running/Paused -stop-> Draining (filas esvaziadas até a GUI) -> Idle
+class CaptureEngine : public QObject {
+    Q_OBJECT
+
+    private:
+        // Sniffers ativos (na ordem das fontes do merge) e os ociosos guardados para reuso
+        std::vector<std::unique_ptr<Sniffer>> sniffers;
+        std::vector<std::unique_ptr<Sniffer>> idleSniffers;
+        std::vector<QString> interfaceNames;
+        TimelineMerger merger;
+        CaptureState state = CaptureState::Idle;
+
+        std::shared_ptr<const PatternMatcher> patternMatcher;
+        std::string filterExpression;
+
+        std::unique_ptr<Sniffer> takeSniffer(const std::string& device, uint8_t index);
+        void pauseSniffers();
+        void handleCaptureError(Sniffer* source, const QString& message);
+
+    public:
+        CaptureEngine(QObject *parent = nullptr);
+        ~CaptureEngine();
+
+        // Captura nas interfaces pedidas (a partir de Idle ou Paused);
+        // devolve false se nenhuma pôde ser aberta
+        bool start(const std::vector<std::string>& devices);
+        void pause();
+        void resume();
+
+        // Esvazia as filas até a GUI e fecha os dispositivos
+        void stop();
+
+        // Filtro BPF aplicado a todas as interfaces, inclusive com a captura rodando.
+        // Expressão inválida: nada muda e a mensagem do libpcap vai para error.
+        bool setFilter(const std::string& expression, std::string& error);
+
+        CaptureState getState() const { return state; }
+        bool isRunning() const { return state == CaptureState::Running; }
+
+        // Interfaces da captura atual (ou da última, se pausada)
+        std::vector<std::string> getDevices() const;
+
+        // Assinaturas aplicadas a partir da próxima chamada a start
+        void setPatternMatcher(std::shared_ptr<const PatternMatcher> matcher) { patternMatcher = std::move(matcher); }
+
+    signals:
+        // Emitido pela thread de merge, já na ordem da linha do tempo unificada
+        void packetCaptured(QString interface, CapturedRow row);
+        void samplingRateChanged(QString interface, int rate);
+        void anomalyDetected(QString interface, Alert alert);
+
+        // Uma interface falhou na leitura: a captura foi pausada e a interface fechada
+        void captureError(QString interface, QString message);
+};
+
+#endif
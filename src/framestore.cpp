@@ -0,0 +1,90 @@
+#include "framestore.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+atomic<size_t> FrameStore::bytesAllocated{0};
+
+FrameStore* FrameStore::forInterface(const string& name)
+{
+    static mutex storesMutex;
+    static vector<unique_ptr<FrameStore>> stores;
+
+    lock_guard<mutex> guard(storesMutex);
+
+    for (auto& store : stores)
+    {
+        if (store->name == name)
+        {
+            return store.get();
+        }
+    }
+
+    stores.push_back(make_unique<FrameStore>(name));
+    return stores.back().get();
+}
+
+size_t FrameStore::chunkCount()
+{
+    static const size_t count = []() {
+        size_t megabytes = DEFAULT_BUDGET_MB;
+        const char* value = getenv("PACKETSNIFFER_FRAME_STORE_MB");
+        if (value && *value)
+        {
+            char* end = nullptr;
+            long parsed = strtol(value, &end, 10);
+            if (end && *end == '\0' && parsed > 0)
+            {
+                megabytes = static_cast<size_t>(parsed);
+            }
+        }
+        return max<size_t>(2, megabytes * 1024 * 1024 / CHUNK_SIZE);
+    }();
+    return count;
+}
+
+FrameStore::FrameStore(const string& n) : name(n), chunks(chunkCount())
+{
+}
+
+uint64_t FrameStore::append(const uint8_t* data, uint32_t length)
+{
+    lock_guard<mutex> guard(lock);
+
+    // Um quadro nunca atravessa blocos: o que não cabe começa no próximo
+    uint64_t offset = writeOffset;
+    size_t used = offset % CHUNK_SIZE;
+    if (used + length > CHUNK_SIZE)
+    {
+        offset += CHUNK_SIZE - used;
+    }
+
+    unique_ptr<uint8_t[]>& chunk = chunks[(offset / CHUNK_SIZE) % chunks.size()];
+    if (!chunk)
+    {
+        chunk.reset(new uint8_t[CHUNK_SIZE]);
+        bytesAllocated.fetch_add(CHUNK_SIZE, memory_order_relaxed);
+    }
+
+    memcpy(chunk.get() + offset % CHUNK_SIZE, data, length);
+    writeOffset = offset + length;
+    return offset;
+}
+
+bool FrameStore::read(uint64_t offset, uint32_t length, vector<uint8_t>& out) const
+{
+    lock_guard<mutex> guard(lock);
+
+    // O bloco do quadro é reaproveitado quando a escrita alcança o mesmo slot uma volta depois
+    uint64_t chunkIndex = offset / CHUNK_SIZE;
+    if (offset + length > writeOffset || writeOffset > (chunkIndex + chunks.size()) * CHUNK_SIZE)
+    {
+        return false;
+    }
+
+    const uint8_t* chunk = chunks[chunkIndex % chunks.size()].get();
+    out.assign(chunk + offset % CHUNK_SIZE, chunk + offset % CHUNK_SIZE + length);
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef FRAMESTORE_HPP
+#define FRAMESTORE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Bytes brutos dos quadros exibidos na tabela, para a decodificação sob demanda.
+//
+// Uma arena por interface, dividida em blocos de CHUNK_SIZE alocados na primeira
+// escrita e reciclados em anel: a memória nunca passa de PACKETSNIFFER_FRAME_STORE_MB
+// (padrão 64 MB) por interface. Cada quadro é identificado pelo seu offset lógico
+// (crescente); quando o bloco que o continha é reciclado, read devolve false.
+//
+// O escritor é a thread de captura da interface; a GUI só lê ao pintar a coluna Info
+// das linhas visíveis e ao selecionar uma linha, então o mutex raramente é disputado.
+class FrameStore
+{
+    public:
+        static constexpr size_t CHUNK_SIZE = 1024 * 1024;
+        static constexpr size_t DEFAULT_BUDGET_MB = 64;
+
+        // Devolve (criando se necessário) a arena de uma interface.
+        // O ponteiro é estável durante toda a execução do programa.
+        static FrameStore* forInterface(const std::string& name);
+
+        explicit FrameStore(const std::string& n);
+
+        FrameStore(const FrameStore&) = delete;
+        FrameStore& operator=(const FrameStore&) = delete;
+
+        const std::string name;
+
+        // Copia o quadro para a arena e devolve o seu offset lógico
+        uint64_t append(const uint8_t* data, uint32_t length);
+
+        // Copia o quadro para out; false se ele já foi sobrescrito
+        bool read(uint64_t offset, uint32_t length, std::vector<uint8_t>& out) const;
+
+        // Memória alocada por todas as arenas
+        static size_t memoryInUse() { return bytesAllocated.load(std::memory_order_relaxed); }
+
+    private:
+        static size_t chunkCount();
+
+        mutable std::mutex lock;
+        std::vector<std::unique_ptr<uint8_t[]>> chunks;
+        uint64_t writeOffset = 0;
+
+        static std::atomic<size_t> bytesAllocated;
+};
+
+#endif
@@ -3,12 +3,21 @@
 #include <iostream>
 #include <QHeaderView>
 #include <QComboBox>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QListWidget>
 #include <QLabel>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QVBoxLayout>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QFont>
+#include <QPlainTextEdit>
+#include <QSplitter>
+#include <QTableView>
 #include <QString>
+#include <chrono>
+#include <cstdlib>
 
 using namespace std;
 
@@ -19,117 +28,412 @@ GUI::GUI()
 
     QPushButton *button = new QPushButton("Analisar!");
     button->setStyleSheet(Styles::buttonAnalyzeStyle());
+    this->start_button = button;
+
+    // O motor vive com a janela: o botão alterna entre pausar e retomar a mesma captura
+    this->analisador = new CaptureEngine(this);
+    QObject::connect(this->analisador, &CaptureEngine::packetCaptured, this, &GUI::updateTable);
+    QObject::connect(this->analisador, &CaptureEngine::samplingRateChanged, this, &GUI::updateSamplingRate);
+    QObject::connect(this->analisador, &CaptureEngine::anomalyDetected, this, &GUI::showAlert);
+    QObject::connect(this->analisador, &CaptureEngine::captureError, this, &GUI::showCaptureError);
 
     QObject::connect(button, &QPushButton::clicked, this, [this, button]() 
     {
-        if (this->has_started)
+        if (this->analisador->isRunning())
         {
-            this->has_started = false;
+            this->analisador->pause();
             button->setText("Analisar!");
             button->setStyleSheet(Styles::buttonAnalyzeStyle());
+        }
+        else
+        {
+            // Interfaces marcadas na lista
+            this->devices_selected.clear();
+            for (int i = 0; i < this->device_list->count(); i++)
+            {
+                QListWidgetItem *item = this->device_list->item(i);
+                if (item->checkState() == Qt::Checked)
+                {
+                    this->devices_selected.push_back(item->text().toStdString());
+                }
+            }
+
+            if (this->devices_selected.empty())
+            {
+                return;
+            }
+
+            // Retomar as mesmas interfaces continua a tabela; outra seleção começa do zero
+            if (this->devices_selected != this->analisador->getDevices())
+            {
+                this->packet_model->clear();
+                this->detail_view->clear();
+                this->sampling_rates.clear();
+                this->refreshSamplingLabel();
+            }
 
-            
-            if (this->analisador) 
+            this->packet_model->retainPatterns(this->pattern_matcher);
+            this->analisador->setPatternMatcher(this->pattern_matcher);
+            if (this->analisador->start(this->devices_selected))
             {
-                this->analisador->disconnect();
-                this->analisador->stopCapture();
-                delete this->analisador;
-                this->analisador = nullptr;
+                button->setText("Pausar");
+                button->setStyleSheet(Styles::buttonStopStyle());
             }
         }
-        else
-        {
-            this->table_widget->setRowCount(0);
+    });
+
+    /*
+        FILTRO BPF
+    */
 
-            this->has_started = true;
-            button->setText("Parar");
-            button->setStyleSheet(Styles::buttonStopStyle());
+    // Aplicado com Enter em todas as interfaces, sem reabrir os dispositivos
+    this->filter_edit = new QLineEdit(this);
+    this->filter_edit->setFixedWidth(700);
+    this->filter_edit->setPlaceholderText("Filtro BPF (ex: tcp port 443 or udp port 53)");
 
-            this->analisador = new Sniffer(this->device_selected);
+    if (const char *env = getenv("PACKETSNIFFER_FILTER"))
+    {
+        this->filter_edit->setText(QString::fromStdString(env));
+        this->applyFilter();
+    }
 
-            QObject::connect(this->analisador, &Sniffer::packetCaptured, this, &GUI::updateTable);
+    QObject::connect(this->filter_edit, &QLineEdit::returnPressed, this, [this]()
+    {
+        this->applyFilter();
+    });
 
-            this->analisador->startCapture();
-        }
+    /*
+        TABELA E DETALHES
+    */
+
+    // A lista guarda só registros compactos; o pacote selecionado é decodificado por completo no painel
+    this->packet_model = new PacketTableModel(this);
+    this->table_view = new QTableView(this);
+    this->table_view->setModel(this->packet_model);
+    this->table_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    this->table_view->setSelectionMode(QAbstractItemView::SingleSelection);
+    this->table_view->verticalHeader()->setVisible(false);
+    this->table_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    QObject::connect(this->table_view->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+                     [this](const QModelIndex &current, const QModelIndex &)
+    {
+        this->showDetails(current.row());
+    });
+
+    this->detail_view = new QPlainTextEdit(this);
+    this->detail_view->setReadOnly(true);
+    this->detail_view->setLineWrapMode(QPlainTextEdit::NoWrap);
+    QFont monospace("Monospace");
+    monospace.setStyleHint(QFont::TypeWriter);
+    this->detail_view->setFont(monospace);
+    this->detail_view->setPlaceholderText("Selecione um pacote para ver os cabeçalhos e o conteúdo.");
+
+    QSplitter *packets_splitter = new QSplitter(Qt::Horizontal, this);
+    packets_splitter->addWidget(this->table_view);
+    packets_splitter->addWidget(this->detail_view);
+    packets_splitter->setSizes({700, 460});
+    packets_splitter->setFixedWidth(1160);
+    packets_splitter->setFixedHeight(300);
+
+    /*
+        GRÁFICO DE TRÁFEGO
+    */
+
+    this->traffic_graph = new TrafficGraph(this);
+    this->traffic_graph->setFixedWidth(1160);
+    this->traffic_graph->setFixedHeight(160);
+
+    QComboBox *span_combo = new QComboBox(this);
+    for (int seconds : TrafficGraph::SPANS_SECONDS)
+    {
+        QString text = seconds >= 3600 ? QString("%1 h").arg(seconds / 3600)
+                     : seconds >= 60 ? QString("%1 min").arg(seconds / 60)
+                     : QString("%1 s").arg(seconds);
+        span_combo->addItem("Últimos " + text);
+    }
+    span_combo->setCurrentIndex(1);
+
+    QObject::connect(span_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index)
+    {
+        this->traffic_graph->setSpan(TrafficGraph::SPANS_SECONDS[index]);
     });
 
+    QComboBox *unit_combo = new QComboBox(this);
+    unit_combo->addItem("Pacotes/s");
+    unit_combo->addItem("Bits/s");
+
+    QObject::connect(unit_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index)
+    {
+        this->traffic_graph->setShowBits(index == 1);
+    });
+
+    QHBoxLayout *graph_row = new QHBoxLayout();
+    graph_row->addWidget(span_combo);
+    graph_row->addWidget(unit_combo);
+    graph_row->addStretch();
+
+    /*
+        ALERTAS
+    */
+
+    // Mais recente no topo; a lista guarda só os últimos MAX_ALERTS
+    this->alerts_list = new QListWidget(this);
+    this->alerts_list->setFixedWidth(1160);
+    this->alerts_list->setFixedHeight(70);
+    this->alerts_list->setStyleSheet(Styles::alertListStyle());
+    this->alerts_list->addItem("Nenhum alerta");
+
+    /*
+        INDICADOR DE AMOSTRAGEM
+    */
+
+    this->sampling_label = new QLabel(this);
+    this->refreshSamplingLabel();
+
     /*
-        TABELA
+        ASSINATURAS DE PAYLOAD
     */
 
-    this->table_widget = new QTableWidget(this);
-    this->table_widget->setColumnCount(4);
-    this->table_widget->setHorizontalHeaderLabels({"Origem", "Dest", "Protocolo", "Tamanho"});
-    this->table_widget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
-    this->table_widget->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
-    this->table_widget->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
-    this->table_widget->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
-    this->table_widget->setFixedWidth(700);
-    this->table_widget->setFixedHeight(600);
+    QPushButton *patterns_button = new QPushButton("Carregar assinaturas...");
+    this->patterns_label = new QLabel(this);
+    this->patterns_label->setStyleSheet(Styles::samplingNormalStyle());
+    this->patterns_label->setText("Nenhuma assinatura carregada");
+
+    QObject::connect(patterns_button, &QPushButton::clicked, this, [this]()
+    {
+        QString path = QFileDialog::getOpenFileName(this, "Arquivo de assinaturas", "", "Assinaturas (*.txt *.rules);;Todos (*)");
+        if (!path.isEmpty())
+        {
+            this->loadPatterns(path);
+        }
+    });
+
+    // Arquivo padrão de assinaturas, carregado na abertura
+    if (const char *env = getenv("PACKETSNIFFER_PATTERNS"))
+    {
+        this->loadPatterns(QString::fromStdString(env));
+    }
+
+    QHBoxLayout *patterns_row = new QHBoxLayout();
+    patterns_row->addWidget(patterns_button);
+    patterns_row->addWidget(patterns_label);
 
     /*
         SELETOR DE DISPOSITIVOS
     */
 
-    QComboBox *device_combo = new QComboBox(this);
-    this->device_selected = "";
+    // Lista com caixas de seleção: várias interfaces podem ser capturadas ao mesmo tempo
+    this->device_list = new QListWidget(this);
+    this->device_list->setFixedWidth(700);
+    this->device_list->setFixedHeight(90);
 
     vector<NetworkDevice> all_devices = Sniffer::listAvailableDevices();
 
     for (const auto &device : all_devices) 
     {
-        device_combo->addItem(QString::fromStdString(device.name));
+        QListWidgetItem *item = new QListWidgetItem(QString::fromStdString(device.name), this->device_list);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
     }
 
     if (!all_devices.empty())
     {
-        this->device_selected = all_devices[0].name;
-        device_combo->setCurrentIndex(0);
+        this->device_list->item(0)->setCheckState(Qt::Checked);
     }
 
-    QObject::connect(
-        device_combo, 
-        QOverload<const QString &>::of(&QComboBox::currentTextChanged),
-        this, 
-        [this](const QString &text) 
+    QObject::connect(this->device_list, &QListWidget::itemChanged, this, [this](QListWidgetItem *)
+    {
+        QStringList names;
+        for (int i = 0; i < this->device_list->count(); i++)
         {
-            this->device_selected = text.toStdString();
-            this->window.setWindowTitle(QString("Analisador de pacotes: ") + text);
+            if (this->device_list->item(i)->checkState() == Qt::Checked)
+            {
+                names << this->device_list->item(i)->text();
+            }
         }
-    );
+        this->window.setWindowTitle(QString("Analisador de pacotes: ") + names.join(", "));
+    });
 
     /*
         INSERE OS COMPONENTES VISUAIS
     */
 
-    this->window.setMinimumSize(800, 800);
-    this->window.setMaximumSize(800, 800);
+    this->window.setMinimumSize(1200, 900);
+    this->window.setMaximumSize(1200, 900);
 
     this->layout = new QVBoxLayout(&window);
     this->layout->addWidget(title_label, 0, Qt::AlignHCenter);
-    this->layout->addWidget(device_combo, 0, Qt::AlignHCenter);
+    this->layout->addWidget(device_list, 0, Qt::AlignHCenter);
+    this->layout->addWidget(filter_edit, 0, Qt::AlignHCenter);
     this->layout->addWidget(button, 0, Qt::AlignHCenter);
-    this->layout->addWidget(table_widget, 0, Qt::AlignHCenter);
+    this->layout->addWidget(sampling_label, 0, Qt::AlignHCenter);
+    this->layout->addLayout(patterns_row);
+    this->layout->addWidget(alerts_list, 0, Qt::AlignHCenter);
+    this->layout->addLayout(graph_row);
+    this->layout->addWidget(traffic_graph, 0, Qt::AlignHCenter);
+    this->layout->addWidget(packets_splitter, 0, Qt::AlignHCenter);
     this->window.show();
 }
 
-void GUI::updateTable(QString src, QString dst, QString protocol, int length) 
+void GUI::updateTable(QString interface, CapturedRow row) 
+{
+    StageTimer<Stage::UpdateTable> timer;
+    Metrics& metrics = Metrics::instance();
+    metrics.queuePopped();
+    auto flushStart = chrono::steady_clock::now();
+
+    this->packet_model->append(interface, row);
+
+    metrics.guiFlushLatency.observe(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - flushStart).count());
+}
+
+void GUI::showDetails(int row)
+{
+    if (row < 0 || row >= this->packet_model->rowCount())
+    {
+        this->detail_view->clear();
+        return;
+    }
+
+    const CapturedRow &captured = this->packet_model->record(row);
+
+    vector<uint8_t> frame;
+    if (!captured.frames || !captured.frames->read(captured.frameOffset, captured.capturedLength, frame))
+    {
+        this->detail_view->setPlainText("Quadro não disponível: já foi sobrescrito no armazenamento de quadros "
+                                        "(aumente PACKETSNIFFER_FRAME_STORE_MB para manter mais histórico).");
+        return;
+    }
+
+    // Decodificação completa em camadas, só para a linha selecionada
+    struct pcap_pkthdr header;
+    header.ts.tv_sec = static_cast<time_t>(captured.timestampNs / 1000000000);
+    header.ts.tv_usec = static_cast<suseconds_t>(captured.timestampNs % 1000000000 / 1000);
+    header.caplen = captured.capturedLength;
+    header.len = static_cast<bpf_u_int32>(captured.length);
+
+    Packet packet = Sniffer::buildPacket(&header, frame.data());
+
+    QString text = QString("Interface: %1\n").arg(this->packet_model->interfaceName(captured));
+    QString info = this->packet_model->infoText(captured);
+    if (!info.isEmpty())
+    {
+        text += "Aplicação: " + info + "\n";
+    }
+    QString tags = this->packet_model->tagsText(captured);
+    if (!tags.isEmpty())
+    {
+        text += "Assinaturas: " + tags + "\n";
+    }
+    text += QString::fromStdString(packet.getDetailedInfo());
+    text += "\n" + QString::fromStdString(packet.getHexDump());
+
+    this->detail_view->setPlainText(text);
+}
+
+void GUI::loadPatterns(const QString &path)
+{
+    // Compila fora da captura; as interfaces passam a usar o novo conjunto no próximo início
+    auto matcher = make_shared<PatternMatcher>();
+    string error;
+    if (!matcher->loadFile(path.toStdString(), error))
+    {
+        cerr << error << endl;
+        this->patterns_label->setText(QString::fromStdString(error));
+        this->patterns_label->setStyleSheet(Styles::samplingActiveStyle());
+        return;
+    }
+
+    this->pattern_matcher = matcher;
+    this->patterns_label->setText(QString("%1 assinaturas (%2 estados)%3")
+        .arg(matcher->patternCount())
+        .arg(matcher->stateCount())
+        .arg(this->analisador->isRunning() ? ", ativas na próxima captura" : ""));
+    this->patterns_label->setStyleSheet(Styles::samplingNormalStyle());
+}
+
+void GUI::applyFilter()
+{
+    string error;
+    if (!this->analisador->setFilter(this->filter_edit->text().trimmed().toStdString(), error))
+    {
+        // Expressão inválida: a captura segue com o filtro anterior
+        this->filter_edit->setStyleSheet(Styles::filterErrorStyle());
+        this->filter_edit->setToolTip(QString::fromStdString(error));
+        return;
+    }
+
+    this->filter_edit->setStyleSheet("");
+    this->filter_edit->setToolTip("");
+}
+
+void GUI::showAlert(QString interface, Alert alert)
+{
+    if (!this->has_alerts)
+    {
+        this->alerts_list->clear();
+        this->has_alerts = true;
+    }
+
+    QString time = QDateTime::fromMSecsSinceEpoch(alert.timestampMs).toString("HH:mm:ss");
+    this->alerts_list->insertItem(0, QString("[%1] %2: %3").arg(time, interface, QString::fromStdString(alert.describe())));
+
+    while (this->alerts_list->count() > MAX_ALERTS)
+    {
+        delete this->alerts_list->takeItem(this->alerts_list->count() - 1);
+    }
+}
+
+void GUI::showCaptureError(QString interface, QString message)
+{
+    // O motor já pausou a captura: o botão volta a oferecer o início
+    this->start_button->setText("Analisar!");
+    this->start_button->setStyleSheet(Styles::buttonAnalyzeStyle());
+
+    if (!this->has_alerts)
+    {
+        this->alerts_list->clear();
+        this->has_alerts = true;
+    }
+
+    QString time = QDateTime::currentDateTime().toString("HH:mm:ss");
+    this->alerts_list->insertItem(0, QString("[%1] %2: erro na captura, interface fechada (%3)").arg(time, interface, message));
+}
+
+void GUI::updateSamplingRate(QString interface, int rate)
 {
-    int row = this->table_widget->rowCount();
-    this->table_widget->insertRow(row);
-
-    QTableWidgetItem *srcItem = new QTableWidgetItem(src);
-    QTableWidgetItem *dstItem = new QTableWidgetItem(dst);
-    QTableWidgetItem *protoItem = new QTableWidgetItem(protocol);
-    QTableWidgetItem *lenItem = new QTableWidgetItem(QString::number(length));
-
-    this->table_widget->setItem(row, 0, srcItem);
-    this->table_widget->setItem(row, 1, dstItem);
-    this->table_widget->setItem(row, 2, protoItem);
-    this->table_widget->setItem(row, 3, lenItem);
+    this->sampling_rates[interface] = rate;
+    this->refreshSamplingLabel();
+}
+
+void GUI::refreshSamplingLabel()
+{
+    QStringList sampled;
+    for (const auto &[interface, rate] : this->sampling_rates)
+    {
+        if (rate > 1)
+        {
+            sampled << QString("%1 1/%2").arg(interface).arg(rate);
+        }
+    }
+
+    if (sampled.isEmpty())
+    {
+        this->sampling_label->setText("Exibindo todos os pacotes");
+        this->sampling_label->setStyleSheet(Styles::samplingNormalStyle());
+    }
+    else
+    {
+        this->sampling_label->setText("Sobrecarga, amostrando: " + sampled.join(", ") + " (contadores exatos)");
+        this->sampling_label->setStyleSheet(Styles::samplingActiveStyle());
+    }
 }
 
 GUI::~GUI() 
 {
+    // Esvazia as filas e fecha os dispositivos antes de a janela sumir
+    this->analisador->stop();
     cout << "Fechando.";
 }
\ No newline at end of file
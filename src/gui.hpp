@@ -1,33 +1,59 @@
 #ifndef GUI_HPP
 #define GUI_HPP
 
-#include "sniffer.hpp"
+#include "engine.hpp"
+#include "trafficgraph.hpp"
+#include "packetmodel.hpp"
 #include <QApplication>
 #include <QWidget>
 #include <QPushButton>
 #include <QLabel>
+#include <QLineEdit>
 #include <QVBoxLayout>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QPlainTextEdit>
+#include <QTableView>
 #include <QMainWindow>
+#include <QListWidget>
+#include <map>
+#include <memory>
 
 class GUI : public QMainWindow
 {
     private:
-        Sniffer *analisador;
+        CaptureEngine *analisador = nullptr;
         QWidget window;
         QVBoxLayout *layout;
-        QTableWidget *table_widget;
+        PacketTableModel *packet_model;
+        QTableView *table_view;
+        QPlainTextEdit *detail_view;
+        QPushButton *start_button;
+        QLabel *sampling_label;
+        QLabel *patterns_label;
+        QListWidget *device_list;
+        QListWidget *alerts_list;
+        bool has_alerts = false;
+        static constexpr int MAX_ALERTS = 200;
+        QLineEdit *filter_edit;
+        TrafficGraph *traffic_graph;
+        std::map<QString, int> sampling_rates;
         int window_size = 800;
-        std::string device_selected;
-        bool has_started = false;
+        std::vector<std::string> devices_selected;
+        std::shared_ptr<const PatternMatcher> pattern_matcher;
+
+        void refreshSamplingLabel();
+        void loadPatterns(const QString &path);
+        void applyFilter();
+        void showDetails(int row);
 
     public:
         GUI();
         ~GUI();
 
     public slots:
-        void updateTable(QString src, QString dst, QString protocol, int length);
+        void updateTable(QString interface, CapturedRow row);
+        void updateSamplingRate(QString interface, int rate);
+        void showAlert(QString interface, Alert alert);
+        void showCaptureError(QString interface, QString message);
 };
 
 #endif
@@ -1,4 +1,5 @@
 #include "gui.hpp"
+#include "metrics.hpp"
 #include <QApplication>
 #include <QProcess>
 #include <unistd.h>
@@ -31,6 +32,11 @@ int main(int argc, char *argv[])
     }
 
     QApplication app(argc, argv);
+
+    // Endpoint local de métricas (PACKETSNIFFER_METRICS_PORT=0 desativa)
+    MetricsServer metricsServer(MetricsServer::portFromEnvironment());
+    metricsServer.start();
+
     GUI* ui = new GUI();
     app.exec();
     return 0;
@@ -0,0 +1,150 @@
+#include "merger.hpp"
+
+using namespace std;
+
+TimelineMerger::TimelineMerger(chrono::milliseconds window) : reorderWindow(window)
+{
+}
+
+TimelineMerger::~TimelineMerger()
+{
+    stop();
+}
+
+void TimelineMerger::setSources(const vector<SpscRing<CapturedRow>*>& rings, RowHandler handler)
+{
+    {
+        lock_guard<mutex> lock(sourcesMutex);
+
+        // O que restou das fontes antigas ainda sai pelo handler antigo
+        while (mergeStep(true))
+        {
+        }
+
+        sources = rings;
+        heads.assign(rings.size(), Head());
+        heap = decltype(heap)();
+        presentHeads = 0;
+        onRow = move(handler);
+    }
+    sourcesChanged.notify_all();
+}
+
+void TimelineMerger::flush()
+{
+    lock_guard<mutex> lock(sourcesMutex);
+    while (mergeStep(true))
+    {
+    }
+}
+
+void TimelineMerger::start()
+{
+    if (running)
+    {
+        return;
+    }
+
+    running = true;
+    mergeThread = std::thread(&TimelineMerger::mergeLoop, this);
+}
+
+void TimelineMerger::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(sourcesMutex);
+        running = false;
+    }
+    sourcesChanged.notify_all();
+
+    if (mergeThread.joinable())
+    {
+        mergeThread.join();
+    }
+}
+
+bool TimelineMerger::refill(size_t source)
+{
+    Head& head = heads[source];
+    if (head.present || !sources[source]->pop(head.row))
+    {
+        return false;
+    }
+
+    head.present = true;
+    heap.push({head.row.timestampNs, source});
+    presentHeads++;
+    return true;
+}
+
+bool TimelineMerger::mergeStep(bool draining)
+{
+    bool progress = false;
+
+    for (size_t s = 0; s < sources.size(); s++)
+    {
+        progress |= refill(s);
+    }
+
+    // Os timestamps do pcap vêm do relógio de parede; linhas mais antigas que a
+    // marca d'água não podem mais ser ultrapassadas por pacotes de outra interface
+    int64_t watermarkNs = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch() - reorderWindow).count();
+
+    while (!heap.empty())
+    {
+        size_t source = heap.top().second;
+        Head& head = heads[source];
+
+        bool ordered = presentHeads == sources.size();
+        bool expired = head.row.timestampNs <= watermarkNs;
+        if (!ordered && !expired && !draining)
+        {
+            break;
+        }
+
+        heap.pop();
+        head.present = false;
+        presentHeads--;
+        onRow(source, head.row);
+        progress = true;
+
+        refill(source);
+    }
+
+    return progress;
+}
+
+void TimelineMerger::mergeLoop()
+{
+    unique_lock<mutex> lock(sourcesMutex);
+
+    while (running)
+    {
+        // Sem fontes (motor ocioso) a thread dorme em vez de consultar as filas
+        if (sources.empty())
+        {
+            sourcesChanged.wait(lock, [this] { return !running || !sources.empty(); });
+            continue;
+        }
+
+        bool progress = mergeStep(false);
+
+        lock.unlock();
+        if (!progress)
+        {
+            this_thread::sleep_for(chrono::milliseconds(IDLE_SLEEP_MS));
+        }
+        lock.lock();
+    }
+
+    // As capturas já pararam: libera tudo o que restou, ainda em ordem
+    while (mergeStep(true))
+    {
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef MERGER_HPP
+#define MERGER_HPP
+
+#include "sniffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Merge k-way ordenado por timestamp das filas de cada interface.
+// Mantém no máximo uma linha "cabeça" por interface em um heap mínimo; a menor é
+// liberada quando todas as interfaces têm cabeça (ordem garantida) ou quando o seu
+// timestamp fica mais antigo que "agora - janela de reordenação" (marca d'água),
+// para que interfaces ociosas não travem a linha do tempo.
+//
+// A thread vive enquanto o merge estiver iniciado; as fontes podem ser trocadas com ela
+// rodando (troca de interfaces sem recriar threads nem filas).
+class TimelineMerger
+{
+    public:
+        using RowHandler = std::function<void(size_t source, CapturedRow& row)>;
+
+        // Sem modo imediato, o pcap segura os pacotes de uma interface quieta por até
+        // READ_TIMEOUT_MS; a janela cobre esse atraso, o sono do merge ocioso e uma folga para
+        // a thread de captura processar o lote. Menor que isso, uma linha atrasada chegaria
+        // depois de linhas mais novas de outra interface já terem sido liberadas.
+        static constexpr int IDLE_SLEEP_MS = 1;
+        static constexpr int CAPTURE_MARGIN_MS = 50;
+        static constexpr int DEFAULT_REORDER_WINDOW_MS = Sniffer::READ_TIMEOUT_MS + IDLE_SLEEP_MS + CAPTURE_MARGIN_MS;
+
+        explicit TimelineMerger(std::chrono::milliseconds window = std::chrono::milliseconds(DEFAULT_REORDER_WINDOW_MS));
+        ~TimelineMerger();
+
+        // Esvazia as fontes atuais e passa a ler das novas. Os produtores das fontes
+        // antigas devem estar parados; pode ser chamado com o merge rodando.
+        void setSources(const std::vector<SpscRing<CapturedRow>*>& rings, RowHandler handler);
+
+        void start();
+
+        // Libera, na ordem do timestamp, tudo o que está nas filas (produtores parados)
+        void flush();
+
+        // Para a thread depois de esvaziar todas as filas, na ordem do timestamp
+        void stop();
+
+    private:
+        struct Head
+        {
+            bool present = false;
+            CapturedRow row;
+        };
+
+        using HeapEntry = std::pair<int64_t, size_t>; // (timestamp, fonte)
+
+        std::vector<SpscRing<CapturedRow>*> sources;
+        std::vector<Head> heads;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+        size_t presentHeads = 0;
+        RowHandler onRow;
+
+        std::chrono::milliseconds reorderWindow;
+        std::thread mergeThread;
+        std::atomic<bool> running{false};
+
+        // Protege fontes, cabeças e handler entre a thread de merge e a de controle
+        std::mutex sourcesMutex;
+        std::condition_variable sourcesChanged;
+
+        bool refill(size_t source);
+
+        // Um passo do merge; devolve true se alguma linha foi lida ou liberada
+        bool mergeStep(bool draining);
+        void mergeLoop();
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include "metrics.hpp"
+#include "namecache.hpp"
+#include "defrag.hpp"
+#include "framestore.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace std;
+
+static const uint16_t DEFAULT_METRICS_PORT = 9101;
+
+// Valor de rótulo no formato de texto do Prometheus: \, " e quebras de linha escapados
+static string escapeLabel(const string& value)
+{
+    string escaped;
+    escaped.reserve(value.size());
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+// ===== LATENCY HISTOGRAM =====
+const array<uint64_t, LatencyHistogram::BUCKET_COUNT> LatencyHistogram::BOUNDS_NS = {
+    250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000, 10000000
+};
+
+void LatencyHistogram::observe(uint64_t nanoseconds)
+{
+    int i = 0;
+    while (i < BUCKET_COUNT && nanoseconds > BOUNDS_NS[i])
+    {
+        i++;
+    }
+
+    buckets[i].fetch_add(1, memory_order_relaxed);
+    sumNs.fetch_add(nanoseconds, memory_order_relaxed);
+    count.fetch_add(1, memory_order_relaxed);
+}
+
+string LatencyHistogram::render(const string& name, const string& help) const
+{
+    ostringstream oss;
+    oss << "# HELP " << name << " " << help << "\n";
+    oss << "# TYPE " << name << " histogram\n";
+
+    // Buckets do Prometheus são cumulativos
+    uint64_t cumulative = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        cumulative += buckets[i].load(memory_order_relaxed);
+        oss << name << "_bucket{le=\"" << (BOUNDS_NS[i] / 1e9) << "\"} " << cumulative << "\n";
+    }
+    cumulative += buckets[BUCKET_COUNT].load(memory_order_relaxed);
+    oss << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+
+    oss << name << "_sum " << (sumNs.load(memory_order_relaxed) / 1e9) << "\n";
+    oss << name << "_count " << count.load(memory_order_relaxed) << "\n";
+    return oss.str();
+}
+
+// ===== METRICS =====
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+InterfaceMetrics* Metrics::interfaceMetrics(const string& name)
+{
+    lock_guard<mutex> lock(interfacesMutex);
+
+    for (auto& iface : interfaces)
+    {
+        if (iface->name == name)
+        {
+            return iface.get();
+        }
+    }
+
+    interfaces.push_back(make_unique<InterfaceMetrics>(name));
+    return interfaces.back().get();
+}
+
+void Metrics::countPacket(InterfaceMetrics& iface, ProtocolCounter protocol, uint32_t length)
+{
+    packetsTotal.fetch_add(1, memory_order_relaxed);
+    bytesTotal.fetch_add(length, memory_order_relaxed);
+    packetsByProtocol[static_cast<size_t>(protocol)].fetch_add(1, memory_order_relaxed);
+
+    iface.packets.fetch_add(1, memory_order_relaxed);
+    iface.bytes.fetch_add(length, memory_order_relaxed);
+}
+
+string Metrics::renderPrometheus() const
+{
+    static const char* PROTOCOL_LABELS[] = { "tcp", "udp", "icmp", "other_ip", "ethernet" };
+
+    ostringstream oss;
+
+    oss << "# HELP packetsniffer_packets_total Pacotes processados pela thread de captura.\n";
+    oss << "# TYPE packetsniffer_packets_total counter\n";
+    oss << "packetsniffer_packets_total " << packetsTotal.load(memory_order_relaxed) << "\n";
+
+    oss << "# HELP packetsniffer_bytes_total Bytes (tamanho real no fio) processados.\n";
+    oss << "# TYPE packetsniffer_bytes_total counter\n";
+    oss << "packetsniffer_bytes_total " << bytesTotal.load(memory_order_relaxed) << "\n";
+
+    oss << "# HELP packetsniffer_decoded_packets_total Pacotes classificados por protocolo (antes da amostragem).\n";
+    oss << "# TYPE packetsniffer_decoded_packets_total counter\n";
+    for (size_t i = 0; i < packetsByProtocol.size(); i++)
+    {
+        oss << "packetsniffer_decoded_packets_total{protocol=\"" << PROTOCOL_LABELS[i] << "\"} "
+            << packetsByProtocol[i].load(memory_order_relaxed) << "\n";
+    }
+
+    oss << "# HELP packetsniffer_gui_queue_depth Sinais emitidos e ainda não consumidos pela GUI.\n";
+    oss << "# TYPE packetsniffer_gui_queue_depth gauge\n";
+    oss << "packetsniffer_gui_queue_depth " << guiQueueDepth.load(memory_order_relaxed) << "\n";
+
+    // Séries por interface, rotuladas com interface="<nome>"
+    struct InterfaceSeries
+    {
+        const char* name;
+        const char* type;
+        const char* help;
+        uint64_t (*read)(const InterfaceMetrics&);
+    };
+
+    static const InterfaceSeries SERIES[] = {
+        {"packetsniffer_interface_packets_total", "counter", "Pacotes capturados na interface.",
+         [](const InterfaceMetrics& m) { return m.packets.load(memory_order_relaxed); }},
+        {"packetsniffer_interface_bytes_total", "counter", "Bytes capturados na interface.",
+         [](const InterfaceMetrics& m) { return m.bytes.load(memory_order_relaxed); }},
+        {"packetsniffer_pcap_received_total", "counter", "Pacotes recebidos pelo filtro (pcap_stats ps_recv).",
+         [](const InterfaceMetrics& m) { return m.pcapReceived.load(memory_order_relaxed); }},
+        {"packetsniffer_pcap_dropped_total", "counter", "Pacotes descartados por falta de buffer (ps_drop).",
+         [](const InterfaceMetrics& m) { return m.pcapDropped.load(memory_order_relaxed); }},
+        {"packetsniffer_pcap_ifdropped_total", "counter", "Pacotes descartados pela interface (ps_ifdrop).",
+         [](const InterfaceMetrics& m) { return m.pcapIfDropped.load(memory_order_relaxed); }},
+        {"packetsniffer_ring_dropped_total", "counter", "Linhas descartadas com a fila da interface cheia.",
+         [](const InterfaceMetrics& m) { return m.ringDropped.load(memory_order_relaxed); }},
+        {"packetsniffer_ring_depth", "gauge", "Linhas aguardando o estágio de merge.",
+         [](const InterfaceMetrics& m) { return static_cast<uint64_t>(m.ringDepth.load(memory_order_relaxed)); }},
+        {"packetsniffer_sampled_out_total", "counter", "Pacotes contados mas não exibidos por causa da amostragem.",
+         [](const InterfaceMetrics& m) { return m.sampledOut.load(memory_order_relaxed); }},
+        {"packetsniffer_sampling_rate", "gauge", "Taxa de amostragem da exibição (1 = todos os pacotes).",
+         [](const InterfaceMetrics& m) { return static_cast<uint64_t>(m.samplingRate.load(memory_order_relaxed)); }},
+        {"packetsniffer_payload_scanned_bytes_total", "counter", "Bytes de payload inspecionados pelo buscador de assinaturas.",
+         [](const InterfaceMetrics& m) { return m.payloadBytesScanned.load(memory_order_relaxed); }},
+        {"packetsniffer_pattern_matched_packets_total", "counter", "Pacotes com ao menos uma assinatura no payload.",
+         [](const InterfaceMetrics& m) { return m.patternMatchedPackets.load(memory_order_relaxed); }},
+        {"packetsniffer_ip_fragments_total", "counter", "Fragmentos IPv4/IPv6 recebidos.",
+         [](const InterfaceMetrics& m) { return m.fragmentsReceived.load(memory_order_relaxed); }},
+        {"packetsniffer_ip_reassembled_total", "counter", "Datagramas remontados a partir de fragmentos.",
+         [](const InterfaceMetrics& m) { return m.datagramsReassembled.load(memory_order_relaxed); }},
+        {"packetsniffer_ip_reassembly_timeouts_total", "counter", "Datagramas incompletos descartados por tempo.",
+         [](const InterfaceMetrics& m) { return m.reassemblyTimeouts.load(memory_order_relaxed); }},
+        {"packetsniffer_ip_reassembly_evictions_total", "counter", "Datagramas descartados por falta de espaço ou fragmentos inválidos.",
+         [](const InterfaceMetrics& m) { return m.reassemblyEvictions.load(memory_order_relaxed); }},
+        {"packetsniffer_syn_flood_alerts_total", "counter", "Alertas de SYN flood (destinos com muitos SYNs sem SYN-ACK).",
+         [](const InterfaceMetrics& m) { return m.synFloodAlerts.load(memory_order_relaxed); }},
+        {"packetsniffer_port_scan_alerts_total", "counter", "Alertas de varredura de portas.",
+         [](const InterfaceMetrics& m) { return m.portScanAlerts.load(memory_order_relaxed); }},
+        {"packetsniffer_fan_out_alerts_total", "counter", "Alertas de origens contatando muitos hosts distintos.",
+         [](const InterfaceMetrics& m) { return m.fanOutAlerts.load(memory_order_relaxed); }},
+    };
+
+    {
+        lock_guard<mutex> lock(interfacesMutex);
+
+        for (const InterfaceSeries& series : SERIES)
+        {
+            oss << "# HELP " << series.name << " " << series.help << "\n";
+            oss << "# TYPE " << series.name << " " << series.type << "\n";
+            for (const auto& iface : interfaces)
+            {
+                oss << series.name << "{interface=\"" << escapeLabel(iface->name) << "\"} " << series.read(*iface) << "\n";
+            }
+        }
+    }
+
+    oss << "# HELP packetsniffer_ip_reassembly_memory_bytes Memória usada pelos datagramas em remontagem (todas as interfaces).\n";
+    oss << "# TYPE packetsniffer_ip_reassembly_memory_bytes gauge\n";
+    oss << "packetsniffer_ip_reassembly_memory_bytes " << Defragmenter::memoryInUse() << "\n";
+
+    oss << "# HELP packetsniffer_frame_store_memory_bytes Memória das arenas de quadros brutos usadas pelo painel de detalhes.\n";
+    oss << "# TYPE packetsniffer_frame_store_memory_bytes gauge\n";
+    oss << "packetsniffer_frame_store_memory_bytes " << FrameStore::memoryInUse() << "\n";
+
+    oss << "# HELP packetsniffer_name_cache_entries Endereços com nome aprendido das respostas DNS.\n";
+    oss << "# TYPE packetsniffer_name_cache_entries gauge\n";
+    oss << "packetsniffer_name_cache_entries " << NameCache::instance().getEntryCount() << "\n";
+
+    oss << decodeLatency.render("packetsniffer_decode_latency_seconds",
+                                "Tempo para montar a linha da tabela de um pacote amostrado.");
+    oss << guiFlushLatency.render("packetsniffer_gui_flush_latency_seconds",
+                                  "Tempo gasto por GUI::updateTable para inserir uma linha.");
+
+    return oss.str();
+}
+
+// ===== METRICS SERVER =====
+MetricsServer::MetricsServer(uint16_t p) : port(p), listenFd(-1)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+uint16_t MetricsServer::portFromEnvironment()
+{
+    const char* value = getenv("PACKETSNIFFER_METRICS_PORT");
+    if (value == nullptr || *value == '\0')
+    {
+        return DEFAULT_METRICS_PORT;
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    unsigned long port = strtoul(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || port > 65535 || value[0] == '-')
+    {
+        cerr << "PACKETSNIFFER_METRICS_PORT inválido (" << value << "); usando a porta "
+             << DEFAULT_METRICS_PORT << endl;
+        return DEFAULT_METRICS_PORT;
+    }
+    return static_cast<uint16_t>(port);
+}
+
+bool MetricsServer::start()
+{
+    if (port == 0 || running)
+    {
+        return false;
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        cerr << "Erro ao criar socket de métricas: " << strerror(errno) << endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Escuta somente em localhost: as métricas não devem ser expostas na rede
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listenFd, 8) < 0)
+    {
+        cerr << "Erro ao abrir porta de métricas " << port << ": " << strerror(errno) << endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    running = true;
+    serverThread = std::thread(&MetricsServer::serveLoop, this);
+
+    cout << "Métricas disponíveis em http://127.0.0.1:" << port << "/metrics" << endl;
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    running = false;
+    if (serverThread.joinable())
+    {
+        serverThread.join();
+    }
+
+    close(listenFd);
+    listenFd = -1;
+}
+
+void MetricsServer::serveLoop()
+{
+    pollfd pfd{};
+    pfd.fd = listenFd;
+    pfd.events = POLLIN;
+
+    while (running)
+    {
+        // Timeout curto para conseguir observar o pedido de parada
+        if (poll(&pfd, 1, 200) <= 0)
+        {
+            continue;
+        }
+
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd >= 0)
+        {
+            // Evita que um cliente lento trave o servidor
+            timeval timeout{1, 0};
+            setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            handleClient(clientFd);
+            close(clientFd);
+        }
+    }
+}
+
+void MetricsServer::handleClient(int clientFd)
+{
+    char request[1024];
+    ssize_t n = recv(clientFd, request, sizeof(request) - 1, 0);
+    if (n <= 0)
+    {
+        return;
+    }
+    request[n] = '\0';
+
+    string status = "200 OK";
+    string body;
+
+    if (strncmp(request, "GET /metrics", 12) == 0)
+    {
+        body = Metrics::instance().renderPrometheus();
+    }
+    else
+    {
+        status = "404 Not Found";
+        body = "Use GET /metrics\n";
+    }
+
+    ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n";
+    response << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    response << "Content-Length: " << body.size() << "\r\n";
+    response << "Connection: close\r\n\r\n";
+    response << body;
+
+    string data = response.str();
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t w = send(clientFd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (w <= 0)
+        {
+            break;
+        }
+        sent += static_cast<size_t>(w);
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Protocolos contabilizados separadamente nas métricas de decodificação
+enum class ProtocolCounter
+{
+    TCP = 0,
+    UDP,
+    ICMP,
+    OtherIP,   // IPv4/IPv6 com protocolo de transporte não suportado
+    Ethernet,  // Quadros sem camada IP reconhecida
+    COUNT
+};
+
+// Histograma de latência com buckets fixos (estilo Prometheus).
+// Todas as operações são lock-free e podem ser chamadas de qualquer thread.
+class LatencyHistogram
+{
+    public:
+        static constexpr int BUCKET_COUNT = 12;
+
+        void observe(uint64_t nanoseconds);
+
+        // Gera as linhas _bucket/_sum/_count no formato de exposição do Prometheus
+        std::string render(const std::string& name, const std::string& help) const;
+
+    private:
+        // Limites superiores (em nanossegundos) de cada bucket; o último slot é o +Inf
+        static const std::array<uint64_t, BUCKET_COUNT> BOUNDS_NS;
+
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT + 1> buckets{};
+        std::atomic<uint64_t> sumNs{0};
+        std::atomic<uint64_t> count{0};
+};
+
+// Contadores de uma interface de captura; cada Sniffer escreve somente no seu
+struct InterfaceMetrics
+{
+    explicit InterfaceMetrics(const std::string& n) : name(n) {}
+
+    const std::string name;
+
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+
+    // Estatísticas do kernel obtidas via pcap_stats(), acumuladas entre aberturas do dispositivo
+    std::atomic<uint64_t> pcapReceived{0};
+    std::atomic<uint64_t> pcapDropped{0};
+    std::atomic<uint64_t> pcapIfDropped{0};
+
+    // Fila da interface até o estágio de merge
+    std::atomic<uint64_t> ringDropped{0};
+    std::atomic<int64_t> ringDepth{0};
+
+    // Amostragem por sobrecarga: pacotes contados mas não decodificados/exibidos
+    std::atomic<uint64_t> sampledOut{0};
+    std::atomic<int> samplingRate{1};
+
+    // Inspeção de payload (somente pacotes decodificados)
+    std::atomic<uint64_t> payloadBytesScanned{0};
+    std::atomic<uint64_t> patternMatchedPackets{0};
+
+    // Remontagem de fragmentos IP
+    std::atomic<uint64_t> fragmentsReceived{0};
+    std::atomic<uint64_t> datagramsReassembled{0};
+    std::atomic<uint64_t> reassemblyTimeouts{0};
+    std::atomic<uint64_t> reassemblyEvictions{0};  // Tabela/orçamento cheios ou fragmentos inválidos
+
+    // Alertas do detector de anomalias
+    std::atomic<uint64_t> synFloodAlerts{0};
+    std::atomic<uint64_t> portScanAlerts{0};
+    std::atomic<uint64_t> fanOutAlerts{0};
+};
+
+// Registro global de contadores da aplicação.
+// Os campos são atômicos e atualizados com memory_order_relaxed no caminho quente.
+class Metrics
+{
+    public:
+        static Metrics& instance();
+
+        // Devolve (criando se necessário) os contadores de uma interface.
+        // O ponteiro é estável durante toda a execução do programa.
+        InterfaceMetrics* interfaceMetrics(const std::string& name);
+
+        void countPacket(InterfaceMetrics& iface, ProtocolCounter protocol, uint32_t length);
+
+        // Sinais emitidos para a GUI e ainda não processados por ela
+        void queuePushed() { guiQueueDepth.fetch_add(1, std::memory_order_relaxed); }
+        void queuePopped() { guiQueueDepth.fetch_sub(1, std::memory_order_relaxed); }
+        int64_t getQueueDepth() const { return guiQueueDepth.load(std::memory_order_relaxed); }
+
+        LatencyHistogram decodeLatency;    // Montagem da linha da tabela de um pacote amostrado (decodeFrame)
+        LatencyHistogram guiFlushLatency;  // GUI::updateTable
+
+        std::string renderPrometheus() const;
+
+    private:
+        Metrics() = default;
+
+        std::atomic<uint64_t> packetsTotal{0};
+        std::atomic<uint64_t> bytesTotal{0};
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(ProtocolCounter::COUNT)> packetsByProtocol{};
+
+        std::atomic<int64_t> guiQueueDepth{0};
+
+        mutable std::mutex interfacesMutex;
+        std::vector<std::unique_ptr<InterfaceMetrics>> interfaces;
+};
+
+// Servidor HTTP mínimo que expõe /metrics em 127.0.0.1 para coletores Prometheus
+class MetricsServer
+{
+    private:
+        uint16_t port;
+        int listenFd;
+        std::thread serverThread;
+        std::atomic<bool> running{false};
+
+        void serveLoop();
+        void handleClient(int clientFd);
+
+    public:
+        explicit MetricsServer(uint16_t port);
+        ~MetricsServer();
+
+        bool start();
+        void stop();
+
+        // Lê a porta de PACKETSNIFFER_METRICS_PORT (0 desativa o servidor)
+        static uint16_t portFromEnvironment();
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "namecache.hpp"
+#include <cstring>
+
+using namespace std;
+
+static size_t addressLength(uint8_t ipVersion)
+{
+    return ipVersion == 6 ? 16 : 4;
+}
+
+NameCache& NameCache::instance()
+{
+    static NameCache cache;
+    return cache;
+}
+
+NameCache::NameCache() : shards(new Shard[SHARD_COUNT])
+{
+}
+
+uint32_t NameCache::hashAddress(uint8_t ipVersion, const uint8_t* addr)
+{
+    // FNV-1a; os bits baixos escolhem o shard e os demais o slot inicial
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < addressLength(ipVersion); i++)
+    {
+        h = (h ^ addr[i]) * 16777619u;
+    }
+    return h;
+}
+
+bool NameCache::sameAddress(const Entry& entry, uint8_t ipVersion, const uint8_t* addr)
+{
+    return entry.used && entry.ipVersion == ipVersion && memcmp(entry.addr, addr, addressLength(ipVersion)) == 0;
+}
+
+void NameCache::insert(uint8_t ipVersion, const uint8_t* addr, string_view name)
+{
+    if (name.empty() || (ipVersion != 4 && ipVersion != 6))
+    {
+        return;
+    }
+
+    uint32_t h = hashAddress(ipVersion, addr);
+    Shard& shard = shards[h % SHARD_COUNT];
+    size_t start = (h / SHARD_COUNT) % SLOTS_PER_SHARD;
+
+    lock_guard<mutex> guard(shard.lock);
+
+    // Procura o próprio endereço na janela de sondagem; senão, um slot livre ou o mais antigo
+    Entry* target = nullptr;
+    for (size_t i = 0; i < PROBE_LIMIT; i++)
+    {
+        Entry& entry = shard.entries[(start + i) % SLOTS_PER_SHARD];
+        if (sameAddress(entry, ipVersion, addr))
+        {
+            target = &entry;
+            break;
+        }
+        if (!entry.used)
+        {
+            if (!target || target->used)
+            {
+                target = &entry;
+            }
+        }
+        else if (!target || (target->used && entry.stamp < target->stamp))
+        {
+            target = &entry;
+        }
+    }
+
+    if (!target->used)
+    {
+        entryCount.fetch_add(1, memory_order_relaxed);
+    }
+
+    target->used = true;
+    target->ipVersion = ipVersion;
+    memset(target->addr, 0, sizeof(target->addr));
+    memcpy(target->addr, addr, addressLength(ipVersion));
+    target->stamp = ++shard.clock;
+    target->name.clear();
+    target->name.append(name);
+}
+
+bool NameCache::lookup(uint8_t ipVersion, const uint8_t* addr, Name& out) const
+{
+    if (ipVersion != 4 && ipVersion != 6)
+    {
+        return false;
+    }
+
+    uint32_t h = hashAddress(ipVersion, addr);
+    const Shard& shard = shards[h % SHARD_COUNT];
+    size_t start = (h / SHARD_COUNT) % SLOTS_PER_SHARD;
+
+    lock_guard<mutex> guard(shard.lock);
+
+    for (size_t i = 0; i < PROBE_LIMIT; i++)
+    {
+        const Entry& entry = shard.entries[(start + i) % SLOTS_PER_SHARD];
+        if (sameAddress(entry, ipVersion, addr))
+        {
+            out.clear();
+            out.append(entry.name.view());
+            return true;
+        }
+    }
+    return false;
+}
+
+void NameCache::clear()
+{
+    for (size_t s = 0; s < SHARD_COUNT; s++)
+    {
+        lock_guard<mutex> guard(shards[s].lock);
+        for (Entry& entry : shards[s].entries)
+        {
+            entry.used = false;
+        }
+    }
+    entryCount.store(0, memory_order_relaxed);
+}
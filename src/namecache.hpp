@@ -0,0 +1,65 @@
+#ifndef NAMECACHE_HPP
+#define NAMECACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include "appdecoders.hpp"
+
+// Cache concorrente IP -> nome, alimentado pelas respostas DNS observadas na captura
+// (nenhuma consulta reversa é feita na rede).
+//
+// Dividido em shards com mutex próprio, para que as threads de captura de várias
+// interfaces raramente disputem o mesmo lock. Cada shard é uma tabela de endereçamento
+// aberto de tamanho fixo: nada é alocado depois da construção, e quando a janela de
+// sondagem está cheia a entrada mais antiga é substituída.
+class NameCache
+{
+    public:
+        static constexpr size_t SHARD_COUNT = 64;
+        static constexpr size_t SLOTS_PER_SHARD = 256;
+        static constexpr size_t PROBE_LIMIT = 8;
+
+        using Name = FixedString<AppInfo::MAX_NAME>;
+
+        static NameCache& instance();
+
+        void insert(uint8_t ipVersion, const uint8_t* addr, std::string_view name);
+
+        // Copia o nome para out; devolve false se o endereço não estiver no cache
+        bool lookup(uint8_t ipVersion, const uint8_t* addr, Name& out) const;
+
+        void clear();
+
+        uint64_t getEntryCount() const { return entryCount.load(std::memory_order_relaxed); }
+
+    private:
+        NameCache();
+
+        struct Entry
+        {
+            bool used = false;
+            uint8_t ipVersion = 0;
+            uint8_t addr[16] = {};
+            uint64_t stamp = 0;      // Ordem de inserção dentro do shard, para a substituição
+            Name name;
+        };
+
+        struct alignas(64) Shard
+        {
+            mutable std::mutex lock;
+            uint64_t clock = 0;
+            std::array<Entry, SLOTS_PER_SHARD> entries;
+        };
+
+        std::unique_ptr<Shard[]> shards;
+        std::atomic<uint64_t> entryCount{0};
+
+        static uint32_t hashAddress(uint8_t ipVersion, const uint8_t* addr);
+        static bool sameAddress(const Entry& entry, uint8_t ipVersion, const uint8_t* addr);
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "overload.hpp"
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static const uint16_t ETHERTYPE_IPV4_VALUE = 0x0800;
+static const uint16_t ETHERTYPE_IPV6_VALUE = 0x86DD;
+static const uint32_t ETHERNET_HEADER_LEN = 14;
+
+static uint16_t read16(const uint8_t* p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// ===== FLOW KEY =====
+static uint32_t read32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(read16(p)) << 16) | read16(p + 2);
+}
+
+// Cabeçalhos de extensão IPv6 que podem preceder o de fragmento
+static bool isIPv6ExtensionHeader(uint8_t nextHeader)
+{
+    return nextHeader == 0 || nextHeader == 43 || nextHeader == 60;  // Hop-by-hop, roteamento, opções de destino
+}
+
+FlowKey FlowKey::extract(const uint8_t* data, uint32_t caplen)
+{
+    FlowKey key;
+    if (caplen < ETHERNET_HEADER_LEN)
+    {
+        return key;
+    }
+
+    key.etherType = read16(data + 12);
+    const uint8_t* ip = data + ETHERNET_HEADER_LEN;
+    uint32_t ipLen = caplen - ETHERNET_HEADER_LEN;
+    uint32_t l4Offset = 0;
+    uint32_t datagramLen = 0;
+
+    if (key.etherType == ETHERTYPE_IPV4_VALUE && ipLen >= 20)
+    {
+        key.ipVersion = 4;
+        key.protocol = ip[9];
+        memcpy(key.srcAddr, ip + 12, 4);
+        memcpy(key.dstAddr, ip + 16, 4);
+        l4Offset = (ip[0] & 0x0F) * 4;
+        datagramLen = read16(ip + 2);
+
+        uint16_t flagsOffset = read16(ip + 6);
+        key.moreFragments = (flagsOffset & 0x2000) != 0;
+        key.fragmentOffset = static_cast<uint16_t>((flagsOffset & 0x1FFF) * 8);
+        key.fragmented = key.moreFragments || key.fragmentOffset != 0;
+        key.fragmentId = read16(ip + 4);
+        key.nextHeaderFieldOffset = 0;
+    }
+    else if (key.etherType == ETHERTYPE_IPV6_VALUE && ipLen >= 40)
+    {
+        key.ipVersion = 6;
+        key.protocol = ip[6];
+        memcpy(key.srcAddr, ip + 8, 16);
+        memcpy(key.dstAddr, ip + 24, 16);
+        l4Offset = 40;
+        datagramLen = 40 + read16(ip + 4);
+
+        // Percorre as extensões até o cabeçalho de fragmento ou de transporte
+        uint32_t nextHeaderField = 6;
+        while (isIPv6ExtensionHeader(key.protocol) && ipLen >= l4Offset + 8)
+        {
+            nextHeaderField = l4Offset;
+            key.protocol = ip[l4Offset];
+            l4Offset += (ip[l4Offset + 1] + 1) * 8;
+        }
+
+        if (key.protocol == 44 && ipLen >= l4Offset + 8)
+        {
+            const uint8_t* fragment = ip + l4Offset;
+            key.fragmented = true;
+            key.nextHeaderFieldOffset = static_cast<uint16_t>(ETHERNET_HEADER_LEN + nextHeaderField);
+            key.protocol = fragment[0];
+            key.fragmentOffset = read16(fragment + 2) & 0xFFF8;
+            key.moreFragments = (fragment[3] & 0x01) != 0;
+            key.fragmentId = read32(fragment + 4);
+            key.unfragmentableLength = static_cast<uint16_t>(ETHERNET_HEADER_LEN + l4Offset);
+            l4Offset += 8;
+        }
+    }
+    else
+    {
+        return key;
+    }
+
+    if (key.fragmented)
+    {
+        if (key.ipVersion == 4)
+        {
+            key.unfragmentableLength = static_cast<uint16_t>(ETHERNET_HEADER_LEN + l4Offset);
+        }
+        // O tamanho vem do cabeçalho IP, não do que foi capturado: um fragmento cortado pelo
+        // snaplen fica maior que o quadro e o Defragmenter o recusa
+        if (l4Offset < datagramLen)
+        {
+            key.fragmentDataOffset = static_cast<uint16_t>(ETHERNET_HEADER_LEN + l4Offset);
+            key.fragmentDataLength = static_cast<uint16_t>(datagramLen - l4Offset);
+        }
+
+        // Fragmentos não iniciais não carregam cabeçalho de transporte
+        if (key.fragmentOffset != 0)
+        {
+            return key;
+        }
+    }
+
+    const uint8_t* l4 = ip + l4Offset;
+    if ((key.protocol == 6 || key.protocol == 17) && ipLen >= l4Offset + 4)
+    {
+        key.srcPort = read16(l4);
+        key.dstPort = read16(l4 + 2);
+    }
+    if (key.protocol == 6 && ipLen >= l4Offset + 14)
+    {
+        key.tcpFlags = l4[13];
+    }
+
+    // Payload de aplicação só existe em datagramas completos
+    if (key.fragmented)
+    {
+        return key;
+    }
+
+    // O tamanho do datagrama no cabeçalho IP descarta o preenchimento de quadros curtos
+    uint32_t headersLen = 0;
+    if (key.protocol == 6 && ipLen >= l4Offset + 13)
+    {
+        headersLen = l4Offset + (l4[12] >> 4) * 4;
+    }
+    else if (key.protocol == 17)
+    {
+        headersLen = l4Offset + 8;
+    }
+
+    uint32_t available = min(ipLen, datagramLen);
+    if (headersLen != 0 && headersLen < available)
+    {
+        key.payloadOffset = static_cast<uint16_t>(ETHERNET_HEADER_LEN + headersLen);
+        key.payloadLength = static_cast<uint16_t>(available - headersLen);
+    }
+
+    return key;
+}
+
+uint32_t FlowKey::hash() const
+{
+    // FNV-1a de cada ponta; a combinação comutativa torna o hash simétrico
+    auto endpointHash = [](const uint8_t* addr, uint16_t port) {
+        uint32_t h = 2166136261u;
+        for (int i = 0; i < 16; i++)
+        {
+            h = (h ^ addr[i]) * 16777619u;
+        }
+        h = (h ^ (port & 0xFF)) * 16777619u;
+        h = (h ^ (port >> 8)) * 16777619u;
+        return h;
+    };
+
+    uint32_t a = endpointHash(srcAddr, srcPort);
+    uint32_t b = endpointHash(dstAddr, dstPort);
+    uint32_t h = (a ^ b) + (a + b) * 0x9E3779B1u + protocol;
+
+    // Mistura final (murmur3) para espalhar os bits baixos usados na amostragem
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+ProtocolCounter FlowKey::protocolCounter() const
+{
+    if (ipVersion == 0)
+    {
+        return ProtocolCounter::Ethernet;
+    }
+
+    switch (protocol)
+    {
+        case 6: return ProtocolCounter::TCP;
+        case 17: return ProtocolCounter::UDP;
+        case 1:
+        case 58: return ProtocolCounter::ICMP;
+        default: return ProtocolCounter::OtherIP;
+    }
+}
+
+// ===== OVERLOAD CONTROLLER =====
+OverloadController::OverloadController(SamplingMode m) : mode(m)
+{
+}
+
+SamplingMode OverloadController::modeFromEnvironment()
+{
+    const char* value = getenv("PACKETSNIFFER_SAMPLING");
+    if (value != nullptr && strcmp(value, "uniform") == 0)
+    {
+        return SamplingMode::Uniform;
+    }
+    return SamplingMode::FlowHash;
+}
+
+void OverloadController::reset()
+{
+    rate.store(1, memory_order_relaxed);
+    packetCounter = 0;
+    lastKernelDrops = 0;
+    calmChecks = 0;
+}
+
+bool OverloadController::shouldSample(const FlowKey& key)
+{
+    uint32_t r = getRate();
+    if (r == 1)
+    {
+        return true;
+    }
+
+    // A taxa é sempre potência de 2, então o módulo vira uma máscara
+    if (mode == SamplingMode::FlowHash)
+    {
+        return (key.hash() & (r - 1)) == 0;
+    }
+    return (packetCounter++ & (r - 1)) == 0;
+}
+
+bool OverloadController::update(int64_t queueDepth, uint64_t kernelDrops)
+{
+    bool newDrops = kernelDrops > lastKernelDrops;
+    lastKernelDrops = kernelDrops;
+
+    uint32_t current = getRate();
+    uint32_t next = current;
+
+    if (queueDepth > HIGH_WATERMARK || newDrops)
+    {
+        // Sobrecarga: dobra a taxa imediatamente
+        calmChecks = 0;
+        if (current < MAX_RATE)
+        {
+            next = current * 2;
+        }
+    }
+    else if (queueDepth < LOW_WATERMARK)
+    {
+        // Histerese: só relaxa depois de várias avaliações calmas seguidas
+        if (++calmChecks >= CALM_CHECKS_TO_RELAX && current > 1)
+        {
+            next = current / 2;
+            calmChecks = 0;
+        }
+    }
+    else
+    {
+        calmChecks = 0;
+    }
+
+    if (next == current)
+    {
+        return false;
+    }
+
+    rate.store(next, memory_order_relaxed);
+    return true;
+}
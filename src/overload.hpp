@@ -0,0 +1,85 @@
+#ifndef OVERLOAD_HPP
+#define OVERLOAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "metrics.hpp"
+
+// Campos mínimos de um quadro, extraídos direto dos bytes sem alocação.
+// Usados para os contadores exatos e para a decisão de amostragem.
+struct FlowKey
+{
+    uint16_t etherType = 0;
+    uint8_t ipVersion = 0;      // 0 = sem IP reconhecido, 4 ou 6
+    uint8_t protocol = 0;       // Protocolo de transporte (IPPROTO_*)
+    uint8_t srcAddr[16] = {};   // IPv4 ocupa os 4 primeiros bytes
+    uint8_t dstAddr[16] = {};
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    uint8_t tcpFlags = 0;
+
+    // Payload de aplicação dentro do quadro (sem o preenchimento Ethernet); 0 se não houver
+    uint16_t payloadOffset = 0;
+    uint16_t payloadLength = 0;
+
+    // Fragmentação IP (flags do IPv4 ou cabeçalho de fragmento do IPv6)
+    bool fragmented = false;
+    bool moreFragments = false;
+    uint16_t fragmentOffset = 0;          // Em bytes, relativo ao início da parte fragmentável
+    uint32_t fragmentId = 0;
+    uint16_t fragmentDataOffset = 0;      // Dados do fragmento dentro do quadro
+    uint16_t fragmentDataLength = 0;      // Segundo o cabeçalho IP; passa do caplen se a captura cortou o quadro
+    uint16_t unfragmentableLength = 0;    // Ethernet + cabeçalhos repetidos em cada fragmento
+    uint16_t nextHeaderFieldOffset = 0;   // IPv6: campo "next header" que aponta para o de fragmento
+
+    // Hash simétrico: os dois sentidos de um fluxo caem no mesmo valor
+    uint32_t hash() const;
+    ProtocolCounter protocolCounter() const;
+
+    static FlowKey extract(const uint8_t* data, uint32_t caplen);
+};
+
+// Como os pacotes são escolhidos quando a taxa de amostragem é maior que 1
+enum class SamplingMode
+{
+    Uniform,   // 1 a cada N pacotes
+    FlowHash   // Fluxos inteiros, escolhidos pelo hash da 5-tupla
+};
+
+// Controlador de sobrecarga: observa a fila até a GUI e os descartes do kernel
+// e ajusta a taxa de amostragem da exibição/decodificação detalhada.
+// Contadores e estatísticas continuam exatos, pois são feitos antes da amostragem.
+class OverloadController
+{
+    public:
+        static constexpr uint32_t MAX_RATE = 1024;
+        static constexpr int64_t HIGH_WATERMARK = 5000;  // Sinais pendentes que disparam a amostragem
+        static constexpr int64_t LOW_WATERMARK = 500;    // Abaixo disso a taxa pode voltar a cair
+        static constexpr int CALM_CHECKS_TO_RELAX = 10;  // Avaliações calmas seguidas antes de reduzir a taxa
+
+        explicit OverloadController(SamplingMode mode = SamplingMode::FlowHash);
+
+        // Caminho quente: decide se o pacote segue para decodificação completa e exibição
+        bool shouldSample(const FlowKey& key);
+
+        // Reavalia a taxa; devolve true se ela mudou
+        bool update(int64_t queueDepth, uint64_t kernelDrops);
+
+        void reset();
+
+        uint32_t getRate() const { return rate.load(std::memory_order_relaxed); }
+        SamplingMode getMode() const { return mode; }
+
+        // Lê PACKETSNIFFER_SAMPLING ("uniform" ou "flow", padrão "flow")
+        static SamplingMode modeFromEnvironment();
+
+    private:
+        SamplingMode mode;
+        std::atomic<uint32_t> rate{1};
+        uint64_t packetCounter = 0;
+        uint64_t lastKernelDrops = 0;
+        int calmChecks = 0;
+};
+
+#endif
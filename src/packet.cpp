@@ -36,6 +36,10 @@ string IPv4Header::toString() const
     oss << "IP Destino: " << dstIP << "\n";
     oss << "TTL: " << (int)ttl << "\n";
     oss << "Protocolo: " << (int)protocol;
+    if (isFragment())
+    {
+        oss << "\nFragmento: offset " << fragmentOffset << (moreFragments ? " (MF)" : "");
+    }
     return oss.str();
 }
 
@@ -49,6 +53,10 @@ string IPv6Header::toString() const
     oss << "IP Destino: " << dstIP << "\n";
     oss << "TTL: " << (int)ttl << "\n";
     oss << "Protocolo: " << (int)protocol;
+    if (isFragment())
+    {
+        oss << "\nFragmento: offset " << fragmentOffset << (moreFragments ? " (MF)" : "");
+    }
     return oss.str();
 }
 
@@ -167,3 +175,41 @@ string Packet::getDetailedInfo() const
     return oss.str();
 }
 
+
+// Dump hexadecimal no formato clássico: offset, 16 bytes em hexa e a coluna ASCII
+string Packet::getHexDump() const
+{
+    ostringstream oss;
+    oss << hex << setfill('0');
+
+    for (size_t line = 0; line < rawData.size(); line += 16)
+    {
+        oss << setw(4) << line << "  ";
+
+        for (size_t i = line; i < line + 16; i++)
+        {
+            if (i < rawData.size())
+            {
+                oss << setw(2) << static_cast<int>(rawData[i]) << " ";
+            }
+            else
+            {
+                oss << "   ";
+            }
+            if (i == line + 7)
+            {
+                oss << " ";
+            }
+        }
+
+        oss << " ";
+        for (size_t i = line; i < line + 16 && i < rawData.size(); i++)
+        {
+            char c = static_cast<char>(rawData[i]);
+            oss << (rawData[i] >= 0x20 && rawData[i] < 0x7F ? c : '.');
+        }
+        oss << "\n";
+    }
+
+    return oss.str();
+}
@@ -36,6 +36,10 @@ class IPHeader
         uint8_t protocol;
         uint8_t ttl;
 
+        // Fragmentação: offset em bytes e flag "more fragments"
+        uint16_t fragmentOffset = 0;
+        bool moreFragments = false;
+
     public:
         IPHeader(const std::string& src, const std::string& dst, uint8_t proto, uint8_t t)
             : srcIP(src), dstIP(dst), protocol(proto), ttl(t) {}
@@ -46,6 +50,11 @@ class IPHeader
         std::string getDstIP() const { return dstIP; }
         uint8_t getProtocol() const { return protocol; }
         uint8_t getTTL() const { return ttl; }
+
+        void setFragment(uint16_t offset, bool more) { fragmentOffset = offset; moreFragments = more; }
+        uint16_t getFragmentOffset() const { return fragmentOffset; }
+        bool hasMoreFragments() const { return moreFragments; }
+        bool isFragment() const { return moreFragments || fragmentOffset != 0; }
         
         virtual std::string toString() const = 0; // Método virtual puro
         virtual std::string getVersionString() const = 0;
@@ -68,7 +77,7 @@ class IPv4Header : public IPHeader
         std::string toString() const override;
 };
 
-// IPv6 (para futuro)
+// IPv6
 class IPv6Header : public IPHeader 
 {
     public:
@@ -215,6 +224,7 @@ class Packet
         
         std::string getSummary() const;
         std::string getDetailedInfo() const;
+        std::string getHexDump() const;
 };
 
 #endif
@@ -0,0 +1,205 @@
+#include "packetmodel.hpp"
+#include "styles.hpp"
+#include <QBrush>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+using namespace std;
+
+// ===== FORMATAÇÃO =====
+// Os mesmos textos que Packet::getDetailedInfo usa para os endereços e protocolos
+
+static QString macText(const uint8_t* mac)
+{
+    static const char HEX[] = "0123456789abcdef";
+    char text[18];
+    for (int i = 0; i < 6; i++)
+    {
+        text[i * 3] = HEX[mac[i] >> 4];
+        text[i * 3 + 1] = HEX[mac[i] & 0x0F];
+        text[i * 3 + 2] = i < 5 ? ':' : '\0';
+    }
+    return QString::fromLatin1(text);
+}
+
+// Nome aprendido das respostas DNS, ou o próprio endereço
+static QString addressText(const CapturedRow &record, const uint8_t* addr)
+{
+    if (record.ipVersion == 0)
+    {
+        return record.capturedLength < 14 ? QString("Desc.") : macText(addr);
+    }
+
+    NameCache::Name name;
+    if (NameCache::instance().lookup(record.ipVersion, addr, name))
+    {
+        return QString::fromUtf8(name.data, static_cast<int>(name.size));
+    }
+
+    char text[INET6_ADDRSTRLEN];
+    inet_ntop(record.ipVersion == 6 ? AF_INET6 : AF_INET, addr, text, sizeof(text));
+    return QString::fromLatin1(text);
+}
+
+static QString protocolText(const CapturedRow &record)
+{
+    if (record.ipVersion == 0)
+    {
+        return record.capturedLength < 14 ? QString("N/A") : QString("Eth");
+    }
+
+    switch (record.protocol)
+    {
+        case IPPROTO_TCP: return "TCP";
+        case IPPROTO_UDP: return "UDP";
+        case IPPROTO_ICMP: return "ICMP";
+        case IPPROTO_ICMPV6: return "ICMPv6";
+        default: return record.ipVersion == 6 ? "IPv6" : "IPv4";
+    }
+}
+
+// ===== MODELO =====
+PacketTableModel::PacketTableModel(QObject *parent) : QAbstractTableModel(parent)
+{
+}
+
+int PacketTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(this->records.size());
+}
+
+int PacketTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant PacketTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(this->records.size()))
+    {
+        return QVariant();
+    }
+
+    const CapturedRow &record = this->records[index.row()];
+
+    // Destaca a linha inteira quando o payload contém alguma assinatura
+    if (role == Qt::BackgroundRole)
+    {
+        return record.matchCount == 0 ? QVariant() : QVariant(QBrush(Styles::patternMatchColor()));
+    }
+
+    if (role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+
+    switch (index.column())
+    {
+        case InterfaceColumn: return this->interfaceNames[record.interfaceIndex];
+        case SourceColumn: return addressText(record, record.srcAddr);
+        case DestinationColumn: return addressText(record, record.dstAddr);
+        case ProtocolColumn: return protocolText(record);
+        case LengthColumn: return record.length;
+        case InfoColumn: return this->infoText(record);
+        case TagsColumn: return this->tagsText(record);
+        default: return QVariant();
+    }
+}
+
+QVariant PacketTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char *HEADERS[] = { "Interface", "Origem", "Dest", "Protocolo", "Tamanho", "Info", "Assinatura" };
+
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= COLUMN_COUNT)
+    {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    return QString(HEADERS[section]);
+}
+
+QString PacketTableModel::infoText(const CapturedRow &record) const
+{
+    if (record.appProtocol == AppProtocol::None)
+    {
+        return QString();
+    }
+
+    // O detalhe (consulta, host, SNI) é redecodificado do quadro guardado; se ele já foi
+    // sobrescrito na arena, resta o protocolo identificado na captura
+    AppInfo app;
+    if (!record.frames || !record.frames->read(record.frameOffset, record.capturedLength, this->frameBuffer))
+    {
+        app.protocol = record.appProtocol;
+    }
+    else
+    {
+        FlowKey key = FlowKey::extract(this->frameBuffer.data(), record.capturedLength);
+        AppDecoder::decode(key, this->frameBuffer.data(), record.capturedLength, app);
+    }
+
+    QString info = QString(app.protocolName());
+    if (!app.detail.empty())
+    {
+        info += " " + QString::fromUtf8(app.detail.data, static_cast<int>(app.detail.size));
+    }
+    if (!app.name.empty())
+    {
+        info += " " + QString::fromUtf8(app.name.data, static_cast<int>(app.name.size));
+    }
+    if (app.addressCount > 0)
+    {
+        info += QString(" (%1 end.)").arg(app.addressCount);
+    }
+    return info;
+}
+
+QString PacketTableModel::tagsText(const CapturedRow &record) const
+{
+    QString tags;
+    for (size_t i = 0; i < record.matchCount; i++)
+    {
+        if (i > 0)
+        {
+            tags += ", ";
+        }
+        tags += QString::fromStdString(record.patterns->patternName(record.matches[i]));
+    }
+    return tags;
+}
+
+void PacketTableModel::append(const QString &interface, const CapturedRow &row)
+{
+    // Poucas interfaces: busca linear no lugar de um QString por linha
+    size_t id = 0;
+    while (id < this->interfaceNames.size() && this->interfaceNames[id] != interface)
+    {
+        id++;
+    }
+    if (id == this->interfaceNames.size())
+    {
+        this->interfaceNames.push_back(interface);
+    }
+
+    int position = static_cast<int>(this->records.size());
+    this->beginInsertRows(QModelIndex(), position, position);
+    this->records.push_back(row);
+    this->records.back().interfaceIndex = static_cast<uint8_t>(id);
+    this->endInsertRows();
+}
+
+void PacketTableModel::retainPatterns(shared_ptr<const PatternMatcher> matcher)
+{
+    if (matcher && (this->patternSets.empty() || this->patternSets.back() != matcher))
+    {
+        this->patternSets.push_back(move(matcher));
+    }
+}
+
+void PacketTableModel::clear()
+{
+    this->beginResetModel();
+    this->records.clear();
+    this->interfaceNames.clear();
+    this->patternSets.clear();
+    this->endResetModel();
+}
@@ -0,0 +1,63 @@
+#ifndef PACKETMODEL_HPP
+#define PACKETMODEL_HPP
+
+#include "sniffer.hpp"
+#include <QAbstractTableModel>
+#include <QString>
+#include <memory>
+#include <vector>
+
+// Modelo da tabela de pacotes (QTableView): cada linha é a CapturedRow compacta (campos
+// brutos e a referência ao quadro no FrameStore), sem nenhum item Qt por célula. Os textos
+// são montados pelo data() só para as linhas visíveis, e o Packet completo só quando a
+// linha é selecionada.
+class PacketTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+    public:
+        enum Column
+        {
+            InterfaceColumn = 0,
+            SourceColumn,
+            DestinationColumn,
+            ProtocolColumn,
+            LengthColumn,
+            InfoColumn,
+            TagsColumn,
+            COLUMN_COUNT
+        };
+
+        explicit PacketTableModel(QObject *parent = nullptr);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+        void append(const QString &interface, const CapturedRow &row);
+        void clear();
+
+        // Mantém vivo o conjunto de assinaturas referenciado pelas linhas (CapturedRow::patterns)
+        // enquanto elas estiverem na tabela, mesmo que outro arquivo seja carregado depois
+        void retainPatterns(std::shared_ptr<const PatternMatcher> matcher);
+
+        const CapturedRow &record(int row) const { return this->records[row]; }
+        const QString &interfaceName(const CapturedRow &record) const { return this->interfaceNames[record.interfaceIndex]; }
+
+        // Textos das colunas Info e Assinatura, também usados pelo painel de detalhes
+        QString infoText(const CapturedRow &record) const;
+        QString tagsText(const CapturedRow &record) const;
+
+    private:
+        // interfaceIndex de cada linha é trocado pelo índice do nome em interfaceNames: o índice
+        // do merge muda entre capturas quando alguma interface não abre
+        std::vector<CapturedRow> records;
+        std::vector<QString> interfaceNames;
+        std::vector<std::shared_ptr<const PatternMatcher>> patternSets;
+
+        // Cópia do quadro relido do FrameStore para a coluna Info, reaproveitada entre chamadas
+        mutable std::vector<uint8_t> frameBuffer;
+};
+
+#endif
@@ -0,0 +1,327 @@
+#include "patterns.hpp"
+#include <cctype>
+#include <fstream>
+#include <queue>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PATTERNS_HAVE_X86 1
+#endif
+
+using namespace std;
+
+void PatternMatcher::addPattern(const string& name, const vector<uint8_t>& bytes)
+{
+    if (bytes.empty())
+    {
+        return;
+    }
+    names.push_back(name);
+    patterns.push_back(bytes);
+}
+
+bool PatternMatcher::parsePattern(const string& line, vector<uint8_t>& bytes)
+{
+    bytes.clear();
+    bool inHex = false;
+    int nibbles = 0;
+    uint8_t current = 0;
+
+    for (char ch : line)
+    {
+        if (ch == '|')
+        {
+            if (inHex && nibbles != 0)
+            {
+                return false; // Byte hexadecimal incompleto
+            }
+            inHex = !inHex;
+            continue;
+        }
+
+        if (!inHex)
+        {
+            bytes.push_back(static_cast<uint8_t>(ch));
+            continue;
+        }
+
+        if (isspace(static_cast<unsigned char>(ch)))
+        {
+            continue;
+        }
+        if (!isxdigit(static_cast<unsigned char>(ch)))
+        {
+            return false;
+        }
+
+        int value = isdigit(static_cast<unsigned char>(ch)) ? ch - '0' : (tolower(ch) - 'a' + 10);
+        current = static_cast<uint8_t>((current << 4) | value);
+        if (++nibbles == 2)
+        {
+            bytes.push_back(current);
+            current = 0;
+            nibbles = 0;
+        }
+    }
+
+    return !inHex && !bytes.empty();
+}
+
+bool PatternMatcher::loadFile(const string& path, string& error)
+{
+    ifstream in(path);
+    if (!in)
+    {
+        error = "Não foi possível abrir " + path;
+        return false;
+    }
+
+    string line;
+    int lineNumber = 0;
+    vector<uint8_t> bytes;
+
+    while (getline(in, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        if (!parsePattern(line, bytes))
+        {
+            error = "Padrão inválido na linha " + to_string(lineNumber) + ": " + line;
+            return false;
+        }
+        addPattern(line, bytes);
+    }
+
+    compile();
+    return true;
+}
+
+void PatternMatcher::compile()
+{
+    // ===== ALFABETO =====
+    fill(begin(byteClass), end(byteClass), 0);
+    fill(begin(firstByte), end(firstByte), false);
+    classCount = 1;
+
+    for (const auto& pattern : patterns)
+    {
+        firstByte[pattern[0]] = true;
+        for (uint8_t b : pattern)
+        {
+            if (byteClass[b] == 0)
+            {
+                byteClass[b] = static_cast<uint8_t>(classCount++);
+            }
+        }
+    }
+
+    // Com todos os 256 bytes em uso a classe 0 fica sem dono; classCount chega a 257
+    // e não cabe em uint8_t, então os bytes passam a mapear para si mesmos
+    if (classCount > 256)
+    {
+        for (int b = 0; b < 256; b++)
+        {
+            byteClass[b] = static_cast<uint8_t>(b);
+        }
+        classCount = 256;
+    }
+
+    // ===== TRIE =====
+    // Na trie, 0 significa "sem filho" (nenhuma aresta aponta para a raiz)
+    transitions.assign(classCount, 0);
+    vector<vector<uint32_t>> stateOutputs(1);
+
+    for (uint32_t id = 0; id < patterns.size(); id++)
+    {
+        uint32_t state = 0;
+        for (uint8_t b : patterns[id])
+        {
+            uint32_t& next = transitions[state * classCount + byteClass[b]];
+            if (next == 0)
+            {
+                next = static_cast<uint32_t>(stateOutputs.size());
+                stateOutputs.emplace_back();
+                transitions.resize(transitions.size() + classCount, 0);
+            }
+            state = transitions[state * classCount + byteClass[b]];
+        }
+        stateOutputs[state].push_back(id);
+    }
+
+    // ===== LINKS DE FALHA (BFS) =====
+    // Completa a DFA: transições ausentes herdam as do estado de falha
+    size_t states = stateOutputs.size();
+    vector<uint32_t> fail(states, 0);
+    queue<uint32_t> pending;
+
+    for (uint32_t c = 0; c < classCount; c++)
+    {
+        uint32_t child = transitions[c];
+        if (child != 0)
+        {
+            fail[child] = 0;
+            pending.push(child);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        uint32_t u = pending.front();
+        pending.pop();
+
+        // Herda as saídas do sufixo mais longo que também é prefixo de algum padrão
+        const vector<uint32_t>& inherited = stateOutputs[fail[u]];
+        stateOutputs[u].insert(stateOutputs[u].end(), inherited.begin(), inherited.end());
+
+        for (uint32_t c = 0; c < classCount; c++)
+        {
+            uint32_t& v = transitions[u * classCount + c];
+            uint32_t viaFail = transitions[fail[u] * classCount + c];
+            if (v != 0)
+            {
+                fail[v] = viaFail;
+                pending.push(v);
+            }
+            else
+            {
+                v = viaFail;
+            }
+        }
+    }
+
+    // ===== SAÍDAS CONTÍGUAS =====
+    outputOffsets.assign(states + 1, 0);
+    outputs.clear();
+    for (size_t s = 0; s < states; s++)
+    {
+        outputOffsets[s] = static_cast<uint32_t>(outputs.size());
+        outputs.insert(outputs.end(), stateOutputs[s].begin(), stateOutputs[s].end());
+    }
+    outputOffsets[states] = static_cast<uint32_t>(outputs.size());
+
+    // ===== PRÉ-FILTRO SHUFTI =====
+    // Cada byte candidato (h, l) marca o bucket h % 8 nas duas tabelas de nibbles;
+    // um byte passa no filtro se lo[l] & hi[h] != 0 (falsos positivos só entre h e h ± 8)
+    fill(begin(shuftiLo), end(shuftiLo), 0);
+    fill(begin(shuftiHi), end(shuftiHi), 0);
+    for (int b = 0; b < 256; b++)
+    {
+        if (firstByte[b])
+        {
+            uint8_t bucket = static_cast<uint8_t>(1u << ((b >> 4) & 7));
+            shuftiLo[b & 0x0F] |= bucket;
+        }
+    }
+    for (int h = 0; h < 16; h++)
+    {
+        shuftiHi[h] = static_cast<uint8_t>(1u << (h & 7));
+    }
+
+#ifdef PATTERNS_HAVE_X86
+    useSimd = __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#ifdef PATTERNS_HAVE_X86
+__attribute__((target("ssse3")))
+size_t PatternMatcher::skipToCandidateSimd(const uint8_t* data, size_t pos, size_t len) const
+{
+    const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(shuftiLo));
+    const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(shuftiHi));
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+
+    while (pos + 16 <= len)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i loNibbles = _mm_and_si128(block, nibbleMask);
+        __m128i hiNibbles = _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask);
+        __m128i hits = _mm_and_si128(_mm_shuffle_epi8(lo, loNibbles), _mm_shuffle_epi8(hi, hiNibbles));
+
+        // Bits em 1 marcam bytes que podem iniciar um padrão
+        unsigned mask = static_cast<unsigned>(~_mm_movemask_epi8(_mm_cmpeq_epi8(hits, zero))) & 0xFFFF;
+        if (mask != 0)
+        {
+            return pos + static_cast<size_t>(__builtin_ctz(mask));
+        }
+        pos += 16;
+    }
+
+    return pos;
+}
+#else
+size_t PatternMatcher::skipToCandidateSimd(const uint8_t*, size_t pos, size_t) const
+{
+    return pos;
+}
+#endif
+
+size_t PatternMatcher::skipToCandidate(const uint8_t* data, size_t pos, size_t len) const
+{
+    if (useSimd)
+    {
+        pos = skipToCandidateSimd(data, pos, len);
+    }
+
+    // Resto do bloco (ou CPU sem SSSE3): consulta direta ao mapa de primeiros bytes
+    while (pos < len && !firstByte[data[pos]])
+    {
+        pos++;
+    }
+    return pos;
+}
+
+size_t PatternMatcher::scan(const uint8_t* data, size_t len, uint32_t* matches, size_t maxMatches) const
+{
+    if (outputOffsets.empty() || len == 0)
+    {
+        return 0;
+    }
+
+    size_t found = 0;
+    uint32_t state = 0;
+    size_t pos = 0;
+
+    while (pos < len)
+    {
+        if (state == 0)
+        {
+            pos = skipToCandidate(data, pos, len);
+            if (pos >= len)
+            {
+                break;
+            }
+        }
+
+        state = transitions[state * classCount + byteClass[data[pos]]];
+        pos++;
+
+        for (uint32_t o = outputOffsets[state]; o < outputOffsets[state + 1]; o++)
+        {
+            uint32_t id = outputs[o];
+            bool seen = false;
+            for (size_t i = 0; i < found; i++)
+            {
+                seen |= matches[i] == id;
+            }
+            if (!seen)
+            {
+                matches[found++] = id;
+                if (found == maxMatches)
+                {
+                    return found;
+                }
+            }
+        }
+    }
+
+    return found;
+}
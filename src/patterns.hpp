@@ -0,0 +1,66 @@
+#ifndef PATTERNS_HPP
+#define PATTERNS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Busca simultânea de muitas assinaturas no payload dos pacotes.
+//
+// Os padrões são compilados em um autômato de Aho-Corasick determinístico (todas as
+// transições pré-calculadas, alfabeto comprimido em classes de bytes), então o custo
+// por byte é uma única consulta de tabela, independente do número de padrões.
+// Enquanto o autômato está na raiz, um pré-filtro SIMD (técnica "shufti", SSSE3)
+// pula blocos de 16 bytes que não contêm o primeiro byte de nenhum padrão.
+//
+// Depois de compile() o objeto é somente leitura e pode ser usado por várias threads.
+class PatternMatcher
+{
+    public:
+        static constexpr size_t MAX_MATCHES = 8;
+
+        // Adiciona um padrão; deve ser chamado antes de compile()
+        void addPattern(const std::string& name, const std::vector<uint8_t>& bytes);
+
+        // Um padrão por linha; trechos entre |...| são bytes em hexadecimal
+        // (ex: "GET /admin", "|de ad be ef|", "Host: |0d 0a|"). Linhas com # são comentários.
+        bool loadFile(const std::string& path, std::string& error);
+        static bool parsePattern(const std::string& line, std::vector<uint8_t>& bytes);
+
+        void compile();
+
+        // Preenche matches com os ids dos padrões encontrados (sem repetição)
+        // e devolve quantos foram encontrados
+        size_t scan(const uint8_t* data, size_t len, uint32_t* matches, size_t maxMatches) const;
+
+        const std::string& patternName(uint32_t id) const { return names[id]; }
+        size_t patternCount() const { return names.size(); }
+        size_t stateCount() const { return outputOffsets.empty() ? 0 : outputOffsets.size() - 1; }
+
+    private:
+        std::vector<std::string> names;
+        std::vector<std::vector<uint8_t>> patterns;
+
+        // Alfabeto comprimido: bytes que não aparecem em nenhum padrão caem na classe 0
+        uint8_t byteClass[256] = {};
+        uint32_t classCount = 1;
+
+        // DFA: transitions[estado * classCount + classe]
+        std::vector<uint32_t> transitions;
+
+        // Saídas de cada estado (já incluindo as herdadas pelos links de falha)
+        std::vector<uint32_t> outputOffsets;
+        std::vector<uint32_t> outputs;
+
+        // Pré-filtro: primeiros bytes dos padrões, como mapa de bits e tabelas shufti
+        bool firstByte[256] = {};
+        alignas(16) uint8_t shuftiLo[16] = {};
+        alignas(16) uint8_t shuftiHi[16] = {};
+        bool useSimd = false;
+
+        size_t skipToCandidate(const uint8_t* data, size_t pos, size_t len) const;
+        size_t skipToCandidateSimd(const uint8_t* data, size_t pos, size_t len) const;
+};
+
+#endif
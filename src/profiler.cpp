@@ -0,0 +1,278 @@
+#include "profiler.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+const char* stageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::PcapLoop: return "pcap_loop";
+        case Stage::StoreFrame: return "store frame";
+        case Stage::PayloadScan: return "payload scan";
+        case Stage::RowFields: return "row fields";
+        case Stage::EmitSignal: return "emit packetCaptured";
+        case Stage::UpdateTable: return "GUI::updateTable";
+        default: return "?";
+    }
+}
+
+// ===== HDR HISTOGRAM =====
+int HdrHistogram::bucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return static_cast<int>(value);
+    }
+
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent >= MAX_EXPONENT)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    int sub = static_cast<int>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+}
+
+uint64_t HdrHistogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return static_cast<uint64_t>(index);
+    }
+
+    int exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+    uint64_t sub = static_cast<uint64_t>((index - SUB_BUCKETS) % SUB_BUCKETS);
+    uint64_t step = 1ull << (exponent - SUB_BUCKET_BITS);
+    return (1ull << exponent) + (sub + 1) * step - 1;
+}
+
+void HdrHistogram::record(uint64_t value)
+{
+    buckets[bucketIndex(value)].fetch_add(1, memory_order_relaxed);
+    count.fetch_add(1, memory_order_relaxed);
+
+    uint64_t currentMax = max.load(memory_order_relaxed);
+    while (value > currentMax && !max.compare_exchange_weak(currentMax, value, memory_order_relaxed))
+    {
+    }
+}
+
+void HdrHistogram::reset()
+{
+    for (auto& bucket : buckets)
+    {
+        bucket.store(0, memory_order_relaxed);
+    }
+    count.store(0, memory_order_relaxed);
+    max.store(0, memory_order_relaxed);
+}
+
+uint64_t HdrHistogram::percentile(double p) const
+{
+    uint64_t total = getCount();
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total));
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += buckets[i].load(memory_order_relaxed);
+        if (seen >= target)
+        {
+            uint64_t bound = bucketUpperBound(i);
+            return bound < getMax() ? bound : getMax();
+        }
+    }
+    return getMax();
+}
+
+// ===== PROFILER =====
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+string Profiler::traceFilePath()
+{
+    const char* value = getenv("PACKETSNIFFER_TRACE_FILE");
+    if (value != nullptr && *value != '\0')
+    {
+        return value;
+    }
+    return "packetsniffer-trace-" + to_string(time(nullptr)) + ".json";
+}
+
+TraceBuffer* Profiler::acquireBuffer()
+{
+    lock_guard<mutex> lock(buffersMutex);
+
+    if (buffersInUse == buffers.size())
+    {
+        auto buffer = make_unique<TraceBuffer>();
+        buffer->events.reserve(EVENTS_PER_THREAD);
+        buffers.push_back(move(buffer));
+    }
+
+    TraceBuffer* buffer = buffers[buffersInUse].get();
+    buffer->threadId = static_cast<uint32_t>(buffersInUse + 1);
+    buffer->events.clear();
+    buffer->droppedEvents = 0;
+    buffersInUse++;
+    return buffer;
+}
+
+void Profiler::record(Stage stage, uint64_t startNs, uint64_t endNs)
+{
+    uint64_t duration = endNs - startNs;
+    histograms[static_cast<size_t>(stage)].record(duration);
+
+    if (!sessionActive.load(memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Cada thread guarda o próprio buffer; nenhuma trava no caminho comum
+    thread_local TraceBuffer* buffer = nullptr;
+    thread_local uint32_t bufferGeneration = 0;
+
+    uint32_t currentGeneration = generation.load(memory_order_acquire);
+    if (buffer == nullptr || bufferGeneration != currentGeneration)
+    {
+        buffer = acquireBuffer();
+        bufferGeneration = currentGeneration;
+    }
+
+    // Marca a escrita e só então confere a sessão: com ordem sequencial, ou endSession vê
+    // writers > 0 e espera, ou esta thread vê a sessão encerrada (ou trocada) e não escreve
+    buffer->writers.fetch_add(1, memory_order_seq_cst);
+    if (sessionActive.load(memory_order_seq_cst) && generation.load(memory_order_relaxed) == bufferGeneration)
+    {
+        if (buffer->events.size() < EVENTS_PER_THREAD)
+        {
+            buffer->events.push_back({stage, startNs, duration});
+        }
+        else
+        {
+            buffer->droppedEvents++;
+        }
+    }
+    buffer->writers.fetch_sub(1, memory_order_release);
+}
+
+void Profiler::beginSession()
+{
+    {
+        lock_guard<mutex> lock(buffersMutex);
+        buffersInUse = 0;
+    }
+
+    for (auto& histogram : histograms)
+    {
+        histogram.reset();
+    }
+
+    sessionStartNs = now();
+    generation.fetch_add(1, memory_order_release);
+    sessionActive = true;
+}
+
+void Profiler::endSession()
+{
+    if (!sessionActive.exchange(false, memory_order_seq_cst))
+    {
+        return;
+    }
+
+    writeChromeTrace(traceFilePath());
+    printSummary();
+}
+
+void Profiler::writeChromeTrace(const string& path)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        cerr << "Erro ao gravar trace em " << path << endl;
+        return;
+    }
+
+    lock_guard<mutex> lock(buffersMutex);
+
+    // A thread de merge e as de captura podem estar no meio de um record(): espera terminarem.
+    // Novas escritas já não acontecem, pois sessionActive foi desligado antes.
+    for (size_t i = 0; i < buffersInUse; i++)
+    {
+        while (buffers[i]->writers.load(memory_order_acquire) != 0)
+        {
+            this_thread::yield();
+        }
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << fixed << setprecision(3);
+
+    bool first = true;
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < buffersInUse; i++)
+    {
+        const TraceBuffer& buffer = *buffers[i];
+        dropped += buffer.droppedEvents;
+
+        if (!first) out << ",\n";
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.threadId
+            << ",\"args\":{\"name\":\"thread " << buffer.threadId << "\"}}";
+
+        for (const TraceEvent& event : buffer.events)
+        {
+            // Chrome trace usa microssegundos
+            double ts = static_cast<double>(event.startNs - sessionStartNs) / 1000.0;
+            double dur = static_cast<double>(event.durationNs) / 1000.0;
+            out << ",\n{\"name\":\"" << stageName(event.stage) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer.threadId << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+        }
+    }
+
+    out << "\n]}\n";
+
+    cout << "Trace de profiling gravado em " << path;
+    if (dropped > 0)
+    {
+        cout << " (" << dropped << " eventos descartados por buffer cheio)";
+    }
+    cout << endl;
+}
+
+void Profiler::printSummary() const
+{
+    cout << "\n========== PROFILING POR ESTÁGIO (ns) ==========\n";
+    cout << left << setw(22) << "Estágio" << right
+         << setw(10) << "amostras" << setw(10) << "p50" << setw(10) << "p90"
+         << setw(10) << "p99" << setw(12) << "max" << "\n";
+
+    for (size_t i = 0; i < histograms.size(); i++)
+    {
+        const HdrHistogram& h = histograms[i];
+        cout << left << setw(22) << stageName(static_cast<Stage>(i)) << right
+             << setw(10) << h.getCount()
+             << setw(10) << h.percentile(50) << setw(10) << h.percentile(90)
+             << setw(10) << h.percentile(99) << setw(12) << h.getMax() << "\n";
+    }
+    cout << "================================================" << endl;
+}
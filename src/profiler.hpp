@@ -0,0 +1,144 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Ativado pela opção PACKETSNIFFER_PROFILING do CMake.
+// Desligado, StageTimer é uma classe vazia e todo o código de medição some na compilação.
+#ifndef PACKETSNIFFER_PROFILING
+#define PACKETSNIFFER_PROFILING 0
+#endif
+
+constexpr bool PROFILING_ENABLED = PACKETSNIFFER_PROFILING != 0;
+
+// Estágios do caminho quente medidos pelo profiler
+enum class Stage
+{
+    PcapLoop = 0,       // Tempo dentro do pcap_loop entre dois callbacks (espera + cópia do kernel)
+    StoreFrame,         // Cópia do quadro exibido para o FrameStore
+    PayloadScan,        // PatternMatcher::scan sobre o payload
+    RowFields,          // Campos brutos da linha (endereços, portas, aplicação)
+    EmitSignal,         // Emissão do sinal packetCaptured pelo merge (enfileiramento no Qt)
+    UpdateTable,        // GUI::updateTable
+    COUNT
+};
+
+const char* stageName(Stage stage);
+
+// Histograma log-linear no estilo HDR: 16 sub-buckets por potência de 2,
+// erro relativo máximo de ~6% e tamanho fixo independente do número de amostras.
+class HdrHistogram
+{
+    public:
+        static constexpr int SUB_BUCKET_BITS = 4;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int MAX_EXPONENT = 48;  // ~78 horas em nanossegundos
+        static constexpr int BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+        void record(uint64_t value);
+        void reset();
+
+        uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+        uint64_t getMax() const { return max.load(std::memory_order_relaxed); }
+        uint64_t percentile(double p) const;
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> max{0};
+
+        static int bucketIndex(uint64_t value);
+        static uint64_t bucketUpperBound(int index);
+};
+
+// Evento de trace no formato "complete event" (ph = "X") do Chrome/Perfetto
+struct TraceEvent
+{
+    Stage stage;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Buffer de eventos de uma única thread; somente a thread dona escreve nele.
+// writers fica não nulo enquanto um record() pode estar escrevendo: endSession espera zerar
+// antes de ler os eventos, e quem ainda guarda o buffer de uma sessão anterior não escreve.
+struct TraceBuffer
+{
+    uint32_t threadId;
+    std::vector<TraceEvent> events;
+    uint64_t droppedEvents = 0;
+    std::atomic<uint32_t> writers{0};
+};
+
+class Profiler
+{
+    private:
+        std::array<HdrHistogram, static_cast<size_t>(Stage::COUNT)> histograms;
+
+        // Buffers são reaproveitados entre sessões; a troca de geração faz
+        // cada thread buscar um buffer novo na próxima medição
+        std::mutex buffersMutex;
+        std::vector<std::unique_ptr<TraceBuffer>> buffers;
+        size_t buffersInUse = 0;
+        std::atomic<uint32_t> generation{0};
+        std::atomic<bool> sessionActive{false};
+        uint64_t sessionStartNs = 0;
+
+        Profiler() = default;
+        TraceBuffer* acquireBuffer();
+        void writeChromeTrace(const std::string& path);
+        void printSummary() const;
+
+    public:
+        static constexpr size_t EVENTS_PER_THREAD = 1 << 18;
+
+        static Profiler& instance();
+
+        static uint64_t now()
+        {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+        }
+
+        void record(Stage stage, uint64_t startNs, uint64_t endNs);
+
+        // Delimitam uma sessão de captura; endSession grava o trace JSON e imprime os percentis
+        void beginSession();
+        void endSession();
+
+        // Arquivo de saída: PACKETSNIFFER_TRACE_FILE ou packetsniffer-trace-<epoch>.json
+        static std::string traceFilePath();
+};
+
+// Mede o tempo de vida do escopo e registra no estágio S
+template <Stage S, bool Enabled = PROFILING_ENABLED>
+class StageTimer
+{
+    private:
+        uint64_t start;
+
+    public:
+        StageTimer() : start(Profiler::now()) {}
+        ~StageTimer() { Profiler::instance().record(S, start, Profiler::now()); }
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+};
+
+// Especialização usada quando o profiling está desligado: não faz nada
+template <Stage S>
+class StageTimer<S, false>
+{
+    public:
+        StageTimer() {}
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef RING_HPP
+#define RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Fila circular lock-free de um produtor e um consumidor (SPSC).
+// A capacidade é arredondada para potência de 2 e as posições são alocadas uma única vez.
+template <typename T>
+class SpscRing
+{
+    private:
+        std::vector<T> cells;
+        size_t mask;
+
+        // Em linhas de cache separadas para evitar false sharing entre as threads
+        alignas(64) std::atomic<size_t> head{0};  // Próximo slot a ler (consumidor)
+        alignas(64) std::atomic<size_t> tail{0};  // Próximo slot a escrever (produtor)
+
+        static size_t roundUpPow2(size_t n)
+        {
+            size_t p = 1;
+            while (p < n)
+            {
+                p <<= 1;
+            }
+            return p;
+        }
+
+    public:
+        explicit SpscRing(size_t capacity) : cells(roundUpPow2(capacity)), mask(cells.size() - 1) {}
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // Produtor: devolve false se a fila estiver cheia
+        bool push(T&& item)
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == cells.size())
+            {
+                return false;
+            }
+            cells[t & mask] = std::move(item);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumidor: devolve false se a fila estiver vazia
+        bool pop(T& out)
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            out = std::move(cells[h & mask]);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t size() const
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const { return cells.size(); }
+};
+
+#endif
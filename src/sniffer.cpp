@@ -4,15 +4,23 @@
 #include <sstream>
 #include <netinet/ether.h>    // Para estruturas Ethernet
 #include <netinet/ip.h>       // Para estruturas IP
+#include <netinet/ip6.h>      // Para estruturas IPv6
 #include <netinet/tcp.h>      // Para estruturas TCP
 #include <netinet/udp.h>      // Para estruturas UDP
 #include <arpa/inet.h>        // Para inet_ntoa, ntohs
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 
 using namespace std;
 
 // Construtor
-Sniffer::Sniffer(string device, QObject *parent) 
-: QObject(parent), deviceName(device), handle(nullptr), capturing(false)
+Sniffer::Sniffer(string device, uint8_t index, QObject *parent) 
+: QObject(parent), deviceName(device), interfaceIndex(index), handle(nullptr), lastCallbackEnd(0),
+  overload(OverloadController::modeFromEnvironment()),
+  ring(RING_CAPACITY), ifaceMetrics(Metrics::instance().interfaceMetrics(device)),
+  trafficSeries(TrafficHistory::instance().series(device)), frameStore(FrameStore::forInterface(device)),
+  defragmenter(ifaceMetrics)
 {
     cout << "Analisador de pacotes iniciado!" << "\n";
 }
@@ -20,62 +28,316 @@ Sniffer::Sniffer(string device, QObject *parent)
 // Destrutor
 Sniffer::~Sniffer() 
 {
-    if (handle) 
+    close();
+
     {
-        pcap_close(handle);
-        cout << "Handle de captura fechado." << endl;
+        lock_guard<mutex> lock(controlMutex);
+        exiting = true;
+    }
+    controlChanged.notify_all();
+
+    if (captureThread.joinable())
+    {
+        captureThread.join();
     }
 }
 
 bool Sniffer::startCapture() 
 {
-    handle = pcap_open_live(deviceName.c_str(), BUFSIZ, 1, 1000, errbuf);
+    string error;
+    if (!open(error))
+    {
+        cerr << "Erro ao abrir dispositivo: " << error << endl;
+        return false;
+    }
+
+    resume();
+    return true;
+}
+
+void Sniffer::stopCapture() 
+{
+    close();
+}
+
+// ===== CICLO DE VIDA =====
+void Sniffer::setDevice(const string& device, uint8_t index)
+{
+    lock_guard<mutex> lock(controlMutex);
+
+    // Mesmo dispositivo: o handle continua aberto e só a posição no merge muda
+    interfaceIndex = index;
+    if (device == deviceName || state != CaptureState::Idle)
+    {
+        return;
+    }
+
+    deviceName = device;
+    ifaceMetrics = Metrics::instance().interfaceMetrics(device);
+    defragmenter.setMetrics(ifaceMetrics);
+    trafficSeries = TrafficHistory::instance().series(device);
+    frameStore = FrameStore::forInterface(device);
+}
+
+bool Sniffer::open(string& error)
+{
+    lock_guard<mutex> lock(controlMutex);
+    if (state != CaptureState::Idle)
+    {
+        return true;
+    }
+
+    handle = pcap_open_live(deviceName.c_str(), BUFSIZ, 1, READ_TIMEOUT_MS, errbuf);
     if (handle == nullptr) 
     {
-        cerr << "Erro ao abrir dispositivo: " << errbuf << endl;
+        error = errbuf;
         return false;
     }
 
-    cout << "Captura iniciada. Pressione Ctrl+C para parar." << endl;
-    capturing = true;
-    shouldStop = false;
-    
-    // Inicia captura em thread separada
-    captureThread = std::thread(&Sniffer::captureLoop, this);
-    
+    // "less 0" nunca casa: instalado durante a pausa, o kernel descarta tudo sem encher o buffer
+    if (pcap_compile(handle, &pausedFilter, "less 0", 1, PCAP_NETMASK_UNKNOWN) != 0 ||
+        pcap_compile(handle, &activeFilter, filterExpression.c_str(), 1, PCAP_NETMASK_UNKNOWN) != 0)
+    {
+        error = pcap_geterr(handle);
+        pcap_freecode(&pausedFilter);
+        pcap_close(handle);
+        handle = nullptr;
+        return false;
+    }
+    pcap_setfilter(handle, &pausedFilter);
+
+    lastStatsRefresh = chrono::steady_clock::time_point();
+    lastStats = pcap_stat{};
+    overload.reset();
+    ifaceMetrics->samplingRate.store(1, memory_order_relaxed);
+    lastCallbackEnd = 0;
+    defragmenter.clear();
+    anomalies.clear();
+
+    state = CaptureState::Paused;
+
+    // A thread de captura é criada uma única vez e reaproveitada nas próximas aberturas
+    if (!captureThread.joinable())
+    {
+        captureThread = std::thread(&Sniffer::captureLoop, this);
+    }
+
+    cout << "Dispositivo " << deviceName << " aberto." << endl;
     return true;
 }
 
-void Sniffer::captureLoop()
+void Sniffer::resume()
 {
-    pcap_loop(handle, -1, staticCallback, reinterpret_cast<u_char*>(this));
-    cout << "Loop de captura terminado." << endl;
-    capturing = false;
+    {
+        lock_guard<mutex> lock(controlMutex);
+        if (state != CaptureState::Paused)
+        {
+            return;
+        }
+
+        pcap_setfilter(handle, &activeFilter);
+        state = CaptureState::Running;
+    }
+    controlChanged.notify_all();
 }
 
-void Sniffer::stopCapture() 
+void Sniffer::pause()
 {
-    if (capturing && handle) 
+    unique_lock<mutex> lock(controlMutex);
+    if (state != CaptureState::Running)
+    {
+        return;
+    }
+
+    // A thread sai do pcap_dispatch e fica esperando; só então o handle pode ser mexido
+    state = CaptureState::Paused;
+    if (dispatching)
     {
-        cout << "Solicitando parada da captura..." << endl;
         pcap_breakloop(handle);
-        
-        if (captureThread.joinable()) 
+    }
+    controlChanged.wait(lock, [this] { return !dispatching; });
+
+    enterPaused();
+}
+
+// Running -> Paused, com controlMutex travado e a thread fora do pcap_dispatch
+void Sniffer::enterPaused()
+{
+    state = CaptureState::Paused;
+    pcap_setfilter(handle, &pausedFilter);
+    updateCaptureStats();
+}
+
+void Sniffer::close()
+{
+    pause();
+
+    lock_guard<mutex> lock(controlMutex);
+    if (state == CaptureState::Idle)
+    {
+        return;
+    }
+
+    updateCaptureStats();
+    pcap_freecode(&pausedFilter);
+    pcap_freecode(&activeFilter);
+    pcap_close(handle);
+    handle = nullptr;
+    state = CaptureState::Idle;
+    cout << "Handle de captura fechado." << endl;
+}
+
+bool Sniffer::validateFilter(const string& expression, string& error)
+{
+    // Compila contra um handle "morto", sem tocar em nenhum dispositivo
+    pcap_t* validator = pcap_open_dead(DLT_EN10MB, BUFSIZ);
+    if (validator == nullptr)
+    {
+        error = "Não foi possível validar o filtro";
+        return false;
+    }
+
+    bpf_program program;
+    if (pcap_compile(validator, &program, expression.c_str(), 1, PCAP_NETMASK_UNKNOWN) != 0)
+    {
+        error = pcap_geterr(validator);
+        pcap_close(validator);
+        return false;
+    }
+    pcap_freecode(&program);
+    pcap_close(validator);
+    return true;
+}
+
+bool Sniffer::setFilter(const string& expression, string& error)
+{
+    if (!validateFilter(expression, error))
+    {
+        return false;
+    }
+
+    // O handle não é thread-safe: com a captura rodando, a troca é feita em pausa
+    bool wasRunning = state == CaptureState::Running;
+    bool applied = true;
+    pause();
+
+    {
+        lock_guard<mutex> lock(controlMutex);
+
+        // O programa anterior só é trocado depois que o novo compila
+        bpf_program compiled{};
+        if (handle && pcap_compile(handle, &compiled, expression.c_str(), 1, PCAP_NETMASK_UNKNOWN) != 0)
         {
-            captureThread.join();
+            error = pcap_geterr(handle);
+            applied = false;
         }
-        
-        if (handle) 
+        else
         {
-            pcap_close(handle);
-            handle = nullptr;
+            if (handle)
+            {
+                pcap_freecode(&activeFilter);
+                activeFilter = compiled;
+            }
+            filterExpression = expression;
         }
     }
+
+    if (wasRunning)
+    {
+        resume();
+    }
+    return applied;
+}
+
+void Sniffer::captureLoop()
+{
+    unique_lock<mutex> lock(controlMutex);
+
+    while (true)
+    {
+        controlChanged.wait(lock, [this] { return exiting || state == CaptureState::Running; });
+        if (exiting)
+        {
+            break;
+        }
+
+        dispatching = true;
+        lock.unlock();
+
+        // Retorna a cada lote do kernel ou a cada READ_TIMEOUT_MS, ou logo após pcap_breakloop
+        int result = pcap_dispatch(handle, -1, staticCallback, reinterpret_cast<u_char*>(this));
+
+        // Ainda com dispatching: o handle não pode ser fechado enquanto a reavaliação o usa
+        auto now = chrono::steady_clock::now();
+        if (now - lastStatsRefresh >= chrono::milliseconds(STATS_INTERVAL_MS))
+        {
+            lastStatsRefresh = now;
+            periodicUpdate(now);
+        }
+
+        lock.lock();
+        dispatching = false;
+        controlChanged.notify_all();
+
+        // Erro de leitura (interface removida, desligada): mesma transição de pause(), e o
+        // CaptureEngine decide o que fazer com a interface
+        if (result == PCAP_ERROR && state == CaptureState::Running)
+        {
+            string message = pcap_geterr(handle);
+            cerr << "Erro na captura em " << deviceName << ": " << message << endl;
+            enterPaused();
+            emit captureError(QString::fromStdString(message));
+        }
+    }
+
+    cout << "Loop de captura terminado." << endl;
+}
+
+// ===== PERIODIC UPDATE =====
+// Descartes, calmaria e fragmentos velhos também acontecem sem pacotes entregues; o loop acorda
+// a cada READ_TIMEOUT_MS, então os contadores do kernel, a taxa de amostragem e a remontagem
+// nunca ficam parados esperando o próximo pacote
+void Sniffer::periodicUpdate(chrono::steady_clock::time_point now)
+{
+    uint64_t kernelDrops = updateCaptureStats();
+    defragmenter.expire(chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count());
+
+    // A pressão vista pela interface é a fila até a GUI mais a sua própria fila até o merge
+    int64_t ringDepth = static_cast<int64_t>(ring.size());
+    ifaceMetrics->ringDepth.store(ringDepth, memory_order_relaxed);
+
+    if (overload.update(Metrics::instance().getQueueDepth() + ringDepth, kernelDrops))
+    {
+        int rate = static_cast<int>(overload.getRate());
+        ifaceMetrics->samplingRate.store(rate, memory_order_relaxed);
+        emit samplingRateChanged(rate);
+    }
+}
+
+uint64_t Sniffer::updateCaptureStats()
+{
+    struct pcap_stat stats;
+    if (handle && pcap_stats(handle, &stats) == 0)
+    {
+        // Os contadores do pcap são de 32 bits e recomeçam a cada handle: as métricas acumulam
+        // as diferenças, para que as séries continuem monotônicas entre aberturas do dispositivo
+        ifaceMetrics->pcapReceived.fetch_add(static_cast<uint32_t>(stats.ps_recv - lastStats.ps_recv), memory_order_relaxed);
+        ifaceMetrics->pcapDropped.fetch_add(static_cast<uint32_t>(stats.ps_drop - lastStats.ps_drop), memory_order_relaxed);
+        ifaceMetrics->pcapIfDropped.fetch_add(static_cast<uint32_t>(stats.ps_ifdrop - lastStats.ps_ifdrop), memory_order_relaxed);
+        lastStats = stats;
+        return static_cast<uint64_t>(stats.ps_drop) + stats.ps_ifdrop;
+    }
+    return 0;
 }
 
 // ===== PARSE ETHERNET HEADER =====
-unique_ptr<EthernetHeader> Sniffer::parseEthernetHeader(const u_char* data) 
+unique_ptr<EthernetHeader> Sniffer::parseEthernetHeader(const u_char* data, uint32_t caplen) 
 {
+    if (caplen < sizeof(struct ether_header))
+    {
+        return nullptr; // Quadro incompleto
+    }
+
     const struct ether_header* eth = (struct ether_header*)data;
     
     // Converte MAC para string
@@ -96,15 +358,72 @@ unique_ptr<EthernetHeader> Sniffer::parseEthernetHeader(const u_char* data)
 }
 
 // ===== PARSE IP HEADER =====
-unique_ptr<IPHeader> Sniffer::parseIPHeader(const u_char* data, uint16_t etherType, int& ipHeaderLen)
+unique_ptr<IPHeader> Sniffer::parseIPHeader(const u_char* data, uint32_t caplen, uint16_t etherType, int& ipHeaderLen)
 {
-    if (etherType != ETHERTYPE_IP) 
+    ipHeaderLen = 0;
+
+    if (etherType == ETHERTYPE_IPV6)
+    {
+        if (caplen < sizeof(struct ether_header) + sizeof(struct ip6_hdr))
+        {
+            return nullptr;
+        }
+
+        const struct ip6_hdr* ip6 = (struct ip6_hdr*)(data + sizeof(struct ether_header));
+
+        char srcIP[INET6_ADDRSTRLEN];
+        char dstIP[INET6_ADDRSTRLEN];
+        inet_ntop(AF_INET6, &ip6->ip6_src, srcIP, sizeof(srcIP));
+        inet_ntop(AF_INET6, &ip6->ip6_dst, dstIP, sizeof(dstIP));
+
+        uint8_t nextHeader = ip6->ip6_nxt;
+        ipHeaderLen = sizeof(struct ip6_hdr);
+
+        // Cabeçalhos de extensão até o de fragmento ou o de transporte
+        const u_char* ipStart = data + sizeof(struct ether_header);
+        while ((nextHeader == IPPROTO_HOPOPTS || nextHeader == IPPROTO_ROUTING || nextHeader == IPPROTO_DSTOPTS) &&
+               sizeof(struct ether_header) + ipHeaderLen + 8 <= caplen)
+        {
+            nextHeader = ipStart[ipHeaderLen];
+            ipHeaderLen += (ipStart[ipHeaderLen + 1] + 1) * 8;
+        }
+
+        uint16_t fragmentOffset = 0;
+        bool moreFragments = false;
+        if (nextHeader == IPPROTO_FRAGMENT && sizeof(struct ether_header) + ipHeaderLen + 8 <= caplen)
+        {
+            const struct ip6_frag* frag = (struct ip6_frag*)(ipStart + ipHeaderLen);
+            nextHeader = frag->ip6f_nxt;
+            fragmentOffset = ntohs(frag->ip6f_offlg & IP6F_OFF_MASK);
+            moreFragments = (frag->ip6f_offlg & IP6F_MORE_FRAG) != 0;
+            ipHeaderLen += sizeof(struct ip6_frag);
+        }
+
+        // Cadeia de extensões que passa do que foi capturado
+        if (sizeof(struct ether_header) + ipHeaderLen > caplen)
+        {
+            ipHeaderLen = 0;
+            return nullptr;
+        }
+
+        auto header = make_unique<IPv6Header>(srcIP, dstIP, nextHeader, ip6->ip6_hlim);
+        header->setFragment(fragmentOffset, moreFragments);
+        return header;
+    }
+
+    if (etherType != ETHERTYPE_IP || caplen < sizeof(struct ether_header) + sizeof(struct ip)) 
     {
-        ipHeaderLen = 0;
-        return nullptr; // Não é IPv4
+        return nullptr; // Não é IP
     }
     
     const struct ip* ip_header = (struct ip*)(data + sizeof(struct ether_header));
+
+    // IHL inválido ou cabeçalho com opções cortado pelo snaplen
+    int headerLen = (ip_header->ip_hl & 0x0f) * 4;
+    if (headerLen < static_cast<int>(sizeof(struct ip)) || sizeof(struct ether_header) + headerLen > caplen)
+    {
+        return nullptr;
+    }
     
     // Extrai informações
     uint8_t version = (ip_header->ip_hl >> 4) & 0x0F;
@@ -113,21 +432,33 @@ unique_ptr<IPHeader> Sniffer::parseIPHeader(const u_char* data, uint16_t etherTy
     uint8_t ttl = ip_header->ip_ttl;
     uint8_t protocol = ip_header->ip_p;
     uint16_t identification = ntohs(ip_header->ip_id);
+    uint16_t flagsOffset = ntohs(ip_header->ip_off);
     
-    // Calcula tamanho do header IP
-    ipHeaderLen = (ip_header->ip_hl & 0x0f) * 4;
+    ipHeaderLen = headerLen;
     
-    return make_unique<IPv4Header>(srcIP, dstIP, protocol, ttl, version, identification);
+    auto header = make_unique<IPv4Header>(srcIP, dstIP, protocol, ttl, version, identification);
+    header->setFragment(static_cast<uint16_t>((flagsOffset & IP_OFFMASK) * 8), (flagsOffset & IP_MF) != 0);
+    return header;
 }
 
 // ===== PARSE TRANSPORT HEADER =====
 unique_ptr<TransportHeader> Sniffer::parseTransportHeader(const u_char* data, 
+                                                           uint32_t caplen,
                                                            uint8_t protocol, 
-                                                           int ipHeaderLen) {
-    const u_char* transportData = data + sizeof(struct ether_header) + ipHeaderLen;
+                                                           int ipHeaderLen,
+                                                           int& transportHeaderLen) {
+    size_t transportOffset = sizeof(struct ether_header) + ipHeaderLen;
+    const u_char* transportData = data + transportOffset;
+    size_t available = caplen > transportOffset ? caplen - transportOffset : 0;
+    transportHeaderLen = 0;
     
     if (protocol == IPPROTO_TCP) 
     {
+        if (available < sizeof(struct tcphdr))
+        {
+            return nullptr; // Cabeçalho TCP cortado pelo snaplen
+        }
+
         const struct tcphdr* tcp = (struct tcphdr*)transportData;
         
         uint16_t srcPort = ntohs(tcp->th_sport);
@@ -135,23 +466,32 @@ unique_ptr<TransportHeader> Sniffer::parseTransportHeader(const u_char* data,
         uint32_t seqNum = ntohl(tcp->th_seq);
         uint32_t ackNum = ntohl(tcp->th_ack);
         uint8_t flags = tcp->th_flags;
+        // Data offset limitado ao cabeçalho mínimo e ao que foi capturado
+        transportHeaderLen = static_cast<int>(min<size_t>(max<size_t>(tcp->th_off * 4, sizeof(struct tcphdr)), available));
         
         return make_unique<TCPHeader>(srcPort, dstPort, seqNum, ackNum, flags);
         
     } 
     else if (protocol == IPPROTO_UDP) 
     {
+        if (available < sizeof(struct udphdr))
+        {
+            return nullptr;
+        }
+
         const struct udphdr* udp = (struct udphdr*)transportData;
         
         uint16_t srcPort = ntohs(udp->uh_sport);
         uint16_t dstPort = ntohs(udp->uh_dport);
         uint16_t length = ntohs(udp->uh_ulen);
+        transportHeaderLen = sizeof(struct udphdr);
         
         return make_unique<UDPHeader>(srcPort, dstPort, length);
         
     } 
-    else if (protocol == IPPROTO_ICMP) 
+    else if (protocol == IPPROTO_ICMP && available >= 8) 
     {
+        transportHeaderLen = 8; // Tipo, código, checksum e os 4 bytes dependentes do tipo
         return make_unique<ICMPHeader>();
     }
     
@@ -171,61 +511,218 @@ Packet Sniffer::buildPacket(const struct pcap_pkthdr* header, const u_char* pack
     packet.setActualLength(header->len);
     packet.setRawData(packetData, header->caplen);
     
-    // Parse Ethernet Header
-    auto ethHeader = parseEthernetHeader(packetData);
+    // Parse Ethernet Header; quadros menores que ele ficam só com os bytes brutos
+    auto ethHeader = parseEthernetHeader(packetData, header->caplen);
+    if (!ethHeader)
+    {
+        return packet;
+    }
     uint16_t etherType = ethHeader->getEtherType();
     packet.setEthernetHeader(move(ethHeader));
     
     // Parse IP Header (se for IPv4)
     int ipHeaderLen = 0;
-    auto ipHeader = parseIPHeader(packetData, etherType, ipHeaderLen);
+    auto ipHeader = parseIPHeader(packetData, header->caplen, etherType, ipHeaderLen);
     
     if (ipHeader) 
     {
         uint8_t protocol = ipHeader->getProtocol();
+        bool carriesTransportHeader = ipHeader->getFragmentOffset() == 0;
         packet.setIPHeader(move(ipHeader));
         
-        // Parse Transport Header
-        auto transportHeader = parseTransportHeader(packetData, protocol, ipHeaderLen);
-        if (transportHeader) 
+        // Parse Transport Header (fragmentos não iniciais só têm dados)
+        int transportHeaderLen = 0;
+        if (carriesTransportHeader)
         {
-            packet.setTransportHeader(move(transportHeader));
+            auto transportHeader = parseTransportHeader(packetData, header->caplen, protocol, ipHeaderLen, transportHeaderLen);
+            if (transportHeader) 
+            {
+                packet.setTransportHeader(move(transportHeader));
+            }
         }
     }
     
     return packet;
 }
 
+// ===== FLOW FIELDS =====
+// Campos brutos da linha a partir da FlowKey, sem alocar os cabeçalhos nem formatar texto:
+// a formatação fica para o PacketTableModel, só nas linhas visíveis
+void Sniffer::fillFlowFields(const FlowKey& key, const u_char* data, uint32_t caplen, CapturedRow& row)
+{
+    row.ipVersion = key.ipVersion;
+    row.protocol = key.protocol;
+    row.srcPort = key.srcPort;
+    row.dstPort = key.dstPort;
+
+    if (key.ipVersion != 0)
+    {
+        memcpy(row.srcAddr, key.srcAddr, sizeof(row.srcAddr));
+        memcpy(row.dstAddr, key.dstAddr, sizeof(row.dstAddr));
+        return;
+    }
+
+    // Sem IP: endereços MAC (capturedLength < 14 fica como quadro não decodificável)
+    if (caplen >= sizeof(struct ether_header))
+    {
+        const struct ether_header* eth = (struct ether_header*)data;
+        memcpy(row.srcAddr, eth->ether_shost, ETH_ALEN);
+        memcpy(row.dstAddr, eth->ether_dhost, ETH_ALEN);
+    }
+}
+
 void Sniffer::staticCallback(u_char* user, const struct pcap_pkthdr* header, const u_char* packetData) {
     Sniffer* sniffer = reinterpret_cast<Sniffer*>(user);
-    
-    // Constrói o pacote estruturado
-    Packet packet = sniffer->buildPacket(header, packetData);
 
-    QString src = "Desc.";
-    QString dst = "Desc.";
-    QString proto = "N/A";
+    if constexpr (PROFILING_ENABLED)
+    {
+        if (sniffer->lastCallbackEnd != 0)
+        {
+            Profiler::instance().record(Stage::PcapLoop, sniffer->lastCallbackEnd, Profiler::now());
+        }
+    }
+
+    sniffer->processFrame(header, packetData);
 
-    if (packet.hasIPHeader())
+    if constexpr (PROFILING_ENABLED)
     {
-        src = QString::fromStdString(packet.getIPHeader()->getSrcIP());
-        dst = QString::fromStdString(packet.getIPHeader()->getDstIP());
-        proto = QString::fromStdString(packet.getIPHeader()->getVersionString());
-    } 
-    else if (packet.hasEthernetHeader())
+        sniffer->lastCallbackEnd = Profiler::now();
+    }
+}
+
+// ===== PROCESS FRAME =====
+// Quadro vindo do pcap: contadores e remontagem de fragmentos (o resto é periódico, em captureLoop)
+void Sniffer::processFrame(const struct pcap_pkthdr* header, const u_char* packetData)
+{
+    Metrics& metrics = Metrics::instance();
+
+    // Contadores exatos: feitos sobre todos os pacotes, antes da amostragem
+    FlowKey key = FlowKey::extract(packetData, header->caplen);
+    ProtocolCounter protocol = key.protocolCounter();
+    metrics.countPacket(*ifaceMetrics, protocol, header->len);
+
+    int64_t timestampNs = static_cast<int64_t>(header->ts.tv_sec) * 1000000000 + header->ts.tv_usec * 1000;
+    trafficSeries->record(timestampNs, protocol, header->len);
+
+    if (!key.fragmented)
     {
-        src = QString::fromStdString(packet.getEthernetHeader()->getSrcMac());
-        dst = QString::fromStdString(packet.getEthernetHeader()->getDstMac());
-        proto = "Eth";
+        decodeFrame(header, packetData, key);
+        return;
     }
 
-    if (packet.hasTransportHeader()) 
+    // Fragmentos só seguem adiante como datagrama completo, que volta ao caminho de decodificação.
+    // A remontagem usa o relógio monotônico, o mesmo da expiração em periodicUpdate.
+    int64_t nowMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    if (defragmenter.add(key, packetData, header->caplen, nowMs, reassemblyBuffer))
     {
-        proto = QString::fromStdString(packet.getTransportHeader()->getProtocolName());
+        struct pcap_pkthdr reassembled = *header;
+        reassembled.caplen = static_cast<bpf_u_int32>(reassemblyBuffer.size());
+        reassembled.len = reassembled.caplen;
+
+        FlowKey fullKey = FlowKey::extract(reassemblyBuffer.data(), reassembled.caplen);
+        decodeFrame(&reassembled, reassemblyBuffer.data(), fullKey);
     }
+}
+
+// ===== DECODE FRAME =====
+// Datagrama completo (original ou remontado): cache de nomes, amostragem e linha da tabela
+void Sniffer::decodeFrame(const struct pcap_pkthdr* header, const u_char* packetData, const FlowKey& key)
+{
+    Metrics& metrics = Metrics::instance();
 
-    emit sniffer->packetCaptured(src, dst, proto, header->len);
+    // Respostas DNS (UDP e TCP) alimentam o cache de nomes em todos os pacotes, mesmo sob amostragem
+    AppInfo app;
+    bool appDecoded = false;
+    if (AppDecoder::isDnsServerReply(key))
+    {
+        appDecoded = true;
+        if (AppDecoder::decode(key, packetData, header->caplen, app))
+        {
+            for (size_t i = 0; i < app.addressCount; i++)
+            {
+                const DnsAddress& address = app.addresses[i];
+                NameCache::instance().insert(address.ipVersion, address.addr, address.name.view());
+            }
+        }
+    }
+
+    // Detector de anomalias também vê todos os pacotes
+    Alert alert;
+    if (anomalies.observe(key, static_cast<int64_t>(header->ts.tv_sec) * 1000 + header->ts.tv_usec / 1000, alert))
+    {
+        reportAlert(alert);
+    }
+
+    if (!overload.shouldSample(key))
+    {
+        ifaceMetrics->sampledOut.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    auto decodeStart = chrono::steady_clock::now();
+
+    CapturedRow row;
+    row.timestampNs = static_cast<int64_t>(header->ts.tv_sec) * 1000000000 + header->ts.tv_usec * 1000;
+    row.interfaceIndex = interfaceIndex;
+    row.length = static_cast<int>(header->len);
+
+    // Inspeção de payload na própria thread de captura da interface
+    if (patterns)
+    {
+        StageTimer<Stage::PayloadScan> timer;
+        size_t matchCount = patterns->scan(packetData + key.payloadOffset, key.payloadLength,
+                                           row.matches, PatternMatcher::MAX_MATCHES);
+        row.patterns = patterns.get();
+        row.matchCount = static_cast<uint8_t>(matchCount);
+        ifaceMetrics->payloadBytesScanned.fetch_add(key.payloadLength, memory_order_relaxed);
+        if (matchCount > 0)
+        {
+            ifaceMetrics->patternMatchedPackets.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    // Só o quadro bruto é guardado; a decodificação em camadas fica para quando a linha for selecionada
+    {
+        StageTimer<Stage::StoreFrame> timer;
+        row.frames = frameStore;
+        row.frameOffset = frameStore->append(packetData, header->caplen);
+        row.capturedLength = header->caplen;
+    }
+
+    {
+        StageTimer<Stage::RowFields> timer;
+        fillFlowFields(key, packetData, header->caplen, row);
+
+        if (!appDecoded)
+        {
+            AppDecoder::decode(key, packetData, header->caplen, app);
+        }
+        row.appProtocol = app.protocol;
+    }
+
+    metrics.decodeLatency.observe(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - decodeStart).count());
+
+    // Entrega ao merge; com a fila cheia a linha é descartada (os contadores já foram feitos)
+    if (!ring.push(move(row)))
+    {
+        ifaceMetrics->ringDropped.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+// ===== ALERTAS =====
+void Sniffer::reportAlert(const Alert& alert)
+{
+    switch (alert.kind)
+    {
+        case AlertKind::SynFlood: ifaceMetrics->synFloodAlerts.fetch_add(1, memory_order_relaxed); break;
+        case AlertKind::PortScan: ifaceMetrics->portScanAlerts.fetch_add(1, memory_order_relaxed); break;
+        case AlertKind::FanOut: ifaceMetrics->fanOutAlerts.fetch_add(1, memory_order_relaxed); break;
+    }
 
+    // Raros (no máximo um por alvo e janela): o arquivo e o sinal não pesam no caminho quente
+    AlertLog::instance().write(deviceName, alert);
+    emit anomalyDetected(alert);
 }
 
 // Método estático para listar todos os dispositivos de rede disponíveis
@@ -1,14 +1,29 @@
 #ifndef SNIFFER_HPP
 #define SNIFFER_HPP
 
+#include <QMetaType>
 #include <QObject>
 #include <string>
 #include <vector>
 #include <memory>
 #include <pcap.h>
 #include "packet.hpp"
+#include "metrics.hpp"
+#include "profiler.hpp"
+#include "overload.hpp"
+#include "ring.hpp"
+#include "patterns.hpp"
+#include "appdecoders.hpp"
+#include "namecache.hpp"
+#include "defrag.hpp"
+#include "timeseries.hpp"
+#include "framestore.hpp"
+#include "anomaly.hpp"
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 // Estrutura para armazenar informações de um dispositivo de rede
 struct NetworkDevice {
@@ -20,45 +35,189 @@ struct NetworkDevice {
         : name(n), description(desc), hasAddress(addr) {}
 };
 
+// Linha da tabela, produzida pela thread de captura de uma interface. Guarda só campos brutos:
+// os textos das colunas são montados pelo PacketTableModel, e apenas para as linhas visíveis.
+struct CapturedRow
+{
+    int64_t timestampNs = 0;    // Relógio do pcap, usado na ordenação do merge
+    uint8_t interfaceIndex = 0; // Fonte no merge; na tabela, índice do nome da interface no modelo
+
+    uint8_t ipVersion = 0;      // 0: sem IP, os endereços são os MACs do quadro Ethernet
+    uint8_t protocol = 0;       // Protocolo de transporte (número IP)
+    uint8_t srcAddr[16] = {};   // IPv4 nos 4 primeiros bytes, MAC nos 6 primeiros
+    uint8_t dstAddr[16] = {};
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    int length = 0;
+
+    // Assinaturas encontradas no payload: ids do PatternMatcher usado na captura
+    const PatternMatcher* patterns = nullptr;
+    uint8_t matchCount = 0;
+    uint32_t matches[PatternMatcher::MAX_MATCHES] = {};
+
+    AppProtocol appProtocol = AppProtocol::None; // Detalhe da coluna Info é redecodificado do quadro
+
+    // Quadro bruto, relido para a coluna Info e para a decodificação completa (painel de detalhes)
+    FrameStore* frames = nullptr;
+    uint64_t frameOffset = 0;
+    uint32_t capturedLength = 0;
+};
+
+Q_DECLARE_METATYPE(CapturedRow)
+Q_DECLARE_METATYPE(Alert)
+
+// Estados de uma captura (usados pelo Sniffer e pelo CaptureEngine)
+enum class CaptureState
+{
+    Idle,      // Dispositivo fechado
+    Running,   // Thread de captura lendo do pcap
+    Paused,    // Dispositivo aberto, thread parada e kernel descartando tudo
+    Draining   // Capturas pausadas, filas sendo esvaziadas até a GUI (somente no CaptureEngine)
+};
+
 class Sniffer : public QObject {
     Q_OBJECT
 
     private:
         std::string deviceName;
+        uint8_t interfaceIndex;
         pcap_t* handle;
         char errbuf[PCAP_ERRBUF_SIZE];
-        bool capturing;
 
-        // Novo membro para a thread de captura
+        // Thread de captura: criada na primeira abertura e reaproveitada até o destrutor.
+        // controlMutex protege handle, dispatching, exiting e os filtros contra a thread de controle.
         std::thread captureThread;
-        std::atomic<bool> shouldStop{false};
+        std::atomic<CaptureState> state{CaptureState::Idle};
+        std::mutex controlMutex;
+        std::condition_variable controlChanged;
+        bool dispatching = false;  // Thread dentro de pcap_dispatch
+        bool exiting = false;
 
-        // Processa dados brutos e constrói um Packet estruturado
-        Packet buildPacket(const struct pcap_pkthdr* header, const u_char* packetData);
-        
-        // Métodos auxiliares para construir cada camada
-        std::unique_ptr<EthernetHeader> parseEthernetHeader(const u_char* data);
-        std::unique_ptr<IPHeader> parseIPHeader(const u_char* data, uint16_t etherType, int& ipHeaderLen);
-        std::unique_ptr<TransportHeader> parseTransportHeader(const u_char* data, 
+        // Filtro BPF do usuário e o filtro que descarta tudo durante a pausa
+        std::string filterExpression;
+        bpf_program activeFilter{};
+        bpf_program pausedFilter{};
+
+        // pcap_stats, controle de sobrecarga e expiração de fragmentos rodam no loop de captura
+        // a cada STATS_INTERVAL_MS (relógio monotônico), com ou sem pacotes chegando
+        static constexpr int64_t STATS_INTERVAL_MS = 100;
+        std::chrono::steady_clock::time_point lastStatsRefresh;
+
+        // Última leitura de pcap_stats do handle atual (zerada a cada abertura)
+        struct pcap_stat lastStats{};
+
+        // Fim do último callback (modo de profiling), para medir o tempo gasto no pcap_loop
+        uint64_t lastCallbackEnd;
+
+        // Ajusta a amostragem da exibição quando a GUI ou o kernel não dão conta
+        OverloadController overload;
+
+        // Linhas decodificadas aguardando o estágio de merge (produtor: thread de captura)
+        SpscRing<CapturedRow> ring;
+        InterfaceMetrics* ifaceMetrics;
+
+        // Pacotes/bytes por protocolo ao longo do tempo, para o gráfico de tráfego
+        TrafficSeries* trafficSeries;
+
+        // Quadros das linhas exibidas, decodificados só quando selecionados na GUI
+        FrameStore* frameStore;
+
+        // Assinaturas procuradas no payload (somente leitura, compartilhadas entre interfaces)
+        std::shared_ptr<const PatternMatcher> patterns;
+
+        // Remontagem de fragmentos IP; o buffer do datagrama remontado é reutilizado
+        Defragmenter defragmenter;
+        std::vector<uint8_t> reassemblyBuffer;
+
+        // SYN flood, varredura de portas e fan-out, sobre todos os datagramas
+        AnomalyDetector anomalies;
+        void reportAlert(const Alert& alert);
+
+        // Métodos auxiliares para construir cada camada; devolvem nullptr quando o cabeçalho
+        // não cabe no que foi capturado (caplen)
+        static std::unique_ptr<EthernetHeader> parseEthernetHeader(const u_char* data, uint32_t caplen);
+        static std::unique_ptr<IPHeader> parseIPHeader(const u_char* data, uint32_t caplen, uint16_t etherType, int& ipHeaderLen);
+        static std::unique_ptr<TransportHeader> parseTransportHeader(const u_char* data, 
+                                                               uint32_t caplen,
                                                                uint8_t protocol, 
-                                                               int ipHeaderLen);
+                                                               int ipHeaderLen,
+                                                               int& transportHeaderLen);
 
         static void staticCallback(u_char* user, const struct pcap_pkthdr* header, const u_char* packetData);
 
         void captureLoop();  // Novo método para rodar em thread
+        void enterPaused();
+
+        // Caminho de um quadro na thread de captura: processFrame conta e remonta fragmentos,
+        // decodeFrame decodifica datagramas completos e entrega a linha ao merge
+        void processFrame(const struct pcap_pkthdr* header, const u_char* packetData);
+        void decodeFrame(const struct pcap_pkthdr* header, const u_char* packetData, const FlowKey& key);
+
+        // Reavaliação periódica feita pelo loop de captura (ver STATS_INTERVAL_MS)
+        void periodicUpdate(std::chrono::steady_clock::time_point now);
+
+        // Copia os contadores do kernel (pcap_stats) para o registro de métricas
+        // e devolve o total de descartes (ps_drop + ps_ifdrop)
+        uint64_t updateCaptureStats();
 
     public:
-        Sniffer(std::string device, QObject *parent = nullptr); // Construtor
+        static constexpr size_t RING_CAPACITY = 8192;
+
+        // Timeout de leitura do pcap: um pacote pode esperar até isso no buffer do kernel
+        // antes de ser entregue (o merge usa o valor para dimensionar a janela de reordenação)
+        static constexpr int READ_TIMEOUT_MS = 100;
+
+        Sniffer(std::string device, uint8_t index = 0, QObject *parent = nullptr); // Construtor
         ~Sniffer(); // Destrutor
+
+        // Atalhos: open + resume / close
         bool startCapture();
         void stopCapture();
+
+        // Ciclo de vida (chamados pela thread de controle):
+        // Idle -open-> Paused -resume-> Running -pause-> Paused -close-> Idle
+        void setDevice(const std::string& device, uint8_t index); // Trocar de dispositivo só em Idle
+        bool open(std::string& error);
+        void resume();
+        void pause();
+        void close();
+
+        // Filtro BPF (pcap_compile/pcap_setfilter); vazio captura tudo.
+        // Com a captura rodando, aplica com uma pausa breve, sem reabrir o dispositivo.
+        bool setFilter(const std::string& expression, std::string& error);
+        static bool validateFilter(const std::string& expression, std::string& error);
+
+        CaptureState getState() const { return state.load(); }
+
+        const std::string& getDeviceName() const { return deviceName; }
+        SpscRing<CapturedRow>& getRing() { return ring; }
+
+        // Entrega um quadro ao mesmo caminho do callback do pcap (processFrame), sem dispositivo
+        // aberto: usado pelo benchmark, na thread que depois esvazia o ring
+        void injectFrame(const struct pcap_pkthdr* header, const u_char* packetData) { processFrame(header, packetData); }
+
+        // Deve ser chamado com a captura pausada ou fechada; nullptr desativa a inspeção de payload
+        void setPatternMatcher(std::shared_ptr<const PatternMatcher> matcher) { patterns = std::move(matcher); }
+
+        // Decodificação completa em camadas (Packet), feita sob demanda pelo painel de detalhes
+        static Packet buildPacket(const struct pcap_pkthdr* header, const u_char* packetData);
+
+        // Campos brutos da linha (endereços, portas, protocolo) a partir da FlowKey e dos bytes
+        static void fillFlowFields(const FlowKey& key, const u_char* data, uint32_t caplen, CapturedRow& row);
         
         // Métodos estáticos para gerenciar dispositivos (não dependem de instância)
         static std::vector<NetworkDevice> listAvailableDevices();
         static std::string selectDeviceInteractive();
 
     signals:
-        void packetCaptured(QString src, QString dst, QString protocol, int length);
+        // Nova taxa de amostragem (1 = todos os pacotes são exibidos)
+        void samplingRateChanged(int rate);
+
+        // Emitido pela thread de captura quando o detector cruza um limite
+        void anomalyDetected(Alert alert);
+
+        // Emitido pela thread de captura quando pcap_dispatch falha; a captura já está em Paused
+        void captureError(QString message);
 };
 
 #endif
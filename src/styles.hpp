@@ -1,6 +1,8 @@
 #ifndef STYLES_HPP
 #define STYLES_HPP
 
+#include <QColor>
+#include <cstddef>
 #include <QString>
 
 class Styles
@@ -46,6 +48,59 @@ class Styles
         {
             return "font-size: 24px; font-weight: bold;";
         }
+
+        static QString samplingNormalStyle()
+        {
+            return "font-size: 12px; color: #555555;";
+        }
+
+        static QString samplingActiveStyle()
+        {
+            return "font-size: 12px; font-weight: bold; color: #CC6600;";
+        }
+
+        // Lista de alertas do detector de anomalias
+        static QString alertListStyle()
+        {
+            return "QListWidget { font-size: 12px; color: #AA0000; }";
+        }
+
+        // Campo de filtro com expressão BPF inválida
+        static QString filterErrorStyle()
+        {
+            return "QLineEdit { border: 1px solid #CC0000; background-color: #FFE5E5; }";
+        }
+
+        // Gráfico de tráfego: uma cor por ProtocolCounter (TCP, UDP, ICMP, outro IP, Ethernet)
+        static QColor protocolColor(size_t index)
+        {
+            static const QColor COLORS[] = {
+                QColor(31, 119, 180), QColor(255, 127, 14), QColor(44, 160, 44),
+                QColor(148, 103, 189), QColor(127, 127, 127)
+            };
+            return COLORS[index % 5];
+        }
+
+        static QColor graphBackgroundColor()
+        {
+            return QColor(250, 250, 250);
+        }
+
+        static QColor graphGridColor()
+        {
+            return QColor(220, 220, 220);
+        }
+
+        static QColor graphTextColor()
+        {
+            return QColor(85, 85, 85);
+        }
+
+        // Fundo das linhas cujo payload contém alguma assinatura
+        static QColor patternMatchColor()
+        {
+            return QColor(255, 230, 150);
+        }
 };
 
 #endif
\ No newline at end of file
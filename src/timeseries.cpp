@@ -0,0 +1,134 @@
+#include "timeseries.hpp"
+
+using namespace std;
+
+constexpr array<int64_t, TrafficSeries::LEVELS> TrafficSeries::BUCKET_NS;
+constexpr array<size_t, TrafficSeries::LEVELS> TrafficSeries::WINDOW;
+constexpr array<size_t, TrafficSeries::LEVELS> TrafficSeries::CAPACITY;
+constexpr int64_t TrafficSeries::READ_DELAY_NS;
+
+TrafficSeries::TrafficSeries(const string& n) : name(n)
+{
+    for (size_t level = 0; level < LEVELS; level++)
+    {
+        levels[level].reset(new Bucket[CAPACITY[level]]);
+    }
+}
+
+void TrafficSeries::record(int64_t timestampNs, ProtocolCounter protocol, uint32_t length)
+{
+    size_t p = static_cast<size_t>(protocol);
+
+    for (size_t level = 0; level < LEVELS; level++)
+    {
+        int64_t index = timestampNs / BUCKET_NS[level];
+        Bucket& bucket = levels[level][static_cast<size_t>(index) % CAPACITY[level]];
+
+        int64_t current = bucket.index.load(memory_order_relaxed);
+        if (current != index)
+        {
+            // Pacote mais antigo que a janela deste nível (relógio voltou): ignorado aqui
+            if (current > index)
+            {
+                continue;
+            }
+
+            // Recicla o bucket: leitores que o pegarem no meio veem o índice mudar
+            bucket.index.store(EMPTY, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+            for (size_t i = 0; i < TrafficTotals::PROTOCOLS; i++)
+            {
+                bucket.packets[i].store(0, memory_order_relaxed);
+                bucket.bytes[i].store(0, memory_order_relaxed);
+            }
+            bucket.index.store(index, memory_order_release);
+        }
+
+        // Único escritor: load + store, sem fetch_add
+        bucket.packets[p].store(bucket.packets[p].load(memory_order_relaxed) + 1, memory_order_relaxed);
+        bucket.bytes[p].store(bucket.bytes[p].load(memory_order_relaxed) + length, memory_order_relaxed);
+    }
+}
+
+bool TrafficSeries::read(SeriesResolution resolution, int64_t index, TrafficTotals& out) const
+{
+    if (index < 0)
+    {
+        return false;
+    }
+
+    size_t level = static_cast<size_t>(resolution);
+    const Bucket& bucket = levels[level][static_cast<size_t>(index) % CAPACITY[level]];
+
+    if (bucket.index.load(memory_order_acquire) != index)
+    {
+        return false;
+    }
+
+    TrafficTotals values;
+    for (size_t i = 0; i < TrafficTotals::PROTOCOLS; i++)
+    {
+        values.packets[i] = bucket.packets[i].load(memory_order_relaxed);
+        values.bytes[i] = bucket.bytes[i].load(memory_order_relaxed);
+    }
+
+    // Reciclado durante a leitura: os valores lidos podem ser de outro intervalo
+    atomic_thread_fence(memory_order_acquire);
+    if (bucket.index.load(memory_order_relaxed) != index)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < TrafficTotals::PROTOCOLS; i++)
+    {
+        out.packets[i] += values.packets[i];
+        out.bytes[i] += values.bytes[i];
+    }
+    return true;
+}
+
+// ===== REGISTRO =====
+TrafficHistory& TrafficHistory::instance()
+{
+    static TrafficHistory history;
+    return history;
+}
+
+TrafficSeries* TrafficHistory::series(const string& name)
+{
+    lock_guard<mutex> lock(seriesMutex);
+
+    for (auto& series : allSeries)
+    {
+        if (series->name == name)
+        {
+            return series.get();
+        }
+    }
+
+    allSeries.push_back(make_unique<TrafficSeries>(name));
+    return allSeries.back().get();
+}
+
+void TrafficHistory::aggregate(SeriesResolution resolution, int64_t first, size_t bucketsPerPoint,
+                               vector<TrafficTotals>& out) const
+{
+    for (TrafficTotals& point : out)
+    {
+        point = TrafficTotals();
+    }
+
+    lock_guard<mutex> lock(seriesMutex);
+
+    for (const auto& series : allSeries)
+    {
+        int64_t index = first;
+        for (TrafficTotals& point : out)
+        {
+            for (size_t i = 0; i < bucketsPerPoint; i++, index++)
+            {
+                series->read(resolution, index, point);
+            }
+        }
+    }
+}
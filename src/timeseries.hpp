@@ -0,0 +1,109 @@
+#ifndef TIMESERIES_HPP
+#define TIMESERIES_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "metrics.hpp"
+
+// Resoluções mantidas para o gráfico de tráfego
+enum class SeriesResolution
+{
+    Millisecond = 0,
+    Second,
+    Minute,
+    COUNT
+};
+
+// Pacotes e bytes por protocolo em um intervalo de tempo
+struct TrafficTotals
+{
+    static constexpr size_t PROTOCOLS = static_cast<size_t>(ProtocolCounter::COUNT);
+
+    std::array<uint64_t, PROTOCOLS> packets{};
+    std::array<uint64_t, PROTOCOLS> bytes{};
+};
+
+// Série temporal de tráfego de uma interface, em três resoluções (1 ms, 1 s, 1 min).
+//
+// Cada resolução é um anel de buckets de tamanho fixo indexado pelo número do bucket
+// (timestamp / duração): a memória não cresce com o tempo de captura, e o que sai da
+// janela é simplesmente sobrescrito. Cada pacote soma nas três resoluções, então
+// nenhuma agregação é feita na leitura além de somar buckets vizinhos.
+//
+// Um único escritor (a thread de captura da interface), sem operações atômicas de
+// leitura-modificação-escrita. Os leitores (GUI) descartam buckets que estão sendo
+// reciclados durante a leitura, no estilo seqlock.
+class TrafficSeries
+{
+    public:
+        static constexpr size_t LEVELS = static_cast<size_t>(SeriesResolution::COUNT);
+        static constexpr std::array<int64_t, LEVELS> BUCKET_NS = {1000000, 1000000000, 60000000000};
+        static constexpr std::array<size_t, LEVELS> WINDOW = {10000, 3600, 1440};  // 10 s, 1 h, 24 h garantidos
+
+        // Atraso máximo com que os leitores consultam o anel (o gráfico espera os pacotes
+        // retidos pelo pcap antes de desenhar o fim da janela)
+        static constexpr int64_t READ_DELAY_NS = 200000000;
+
+        // Cada anel cobre a janela inteira mesmo lida com READ_DELAY_NS de atraso: a folga
+        // soma os buckets do atraso, o bucket em preenchimento e o último, ainda incompleto
+        static constexpr std::array<size_t, LEVELS> CAPACITY = {
+            WINDOW[0] + static_cast<size_t>((READ_DELAY_NS + BUCKET_NS[0] - 1) / BUCKET_NS[0]) + 2,
+            WINDOW[1] + static_cast<size_t>((READ_DELAY_NS + BUCKET_NS[1] - 1) / BUCKET_NS[1]) + 2,
+            WINDOW[2] + static_cast<size_t>((READ_DELAY_NS + BUCKET_NS[2] - 1) / BUCKET_NS[2]) + 2,
+        };
+
+        explicit TrafficSeries(const std::string& n);
+
+        TrafficSeries(const TrafficSeries&) = delete;
+        TrafficSeries& operator=(const TrafficSeries&) = delete;
+
+        const std::string name;
+
+        // Somente a thread de captura da interface
+        void record(int64_t timestampNs, ProtocolCounter protocol, uint32_t length);
+
+        // Soma em out o bucket de número index; devolve false se ele não está mais
+        // (ou ainda não está) no anel
+        bool read(SeriesResolution resolution, int64_t index, TrafficTotals& out) const;
+
+    private:
+        static constexpr int64_t EMPTY = -1;
+
+        struct Bucket
+        {
+            std::atomic<int64_t> index{EMPTY};
+            std::array<std::atomic<uint64_t>, TrafficTotals::PROTOCOLS> packets{};
+            std::array<std::atomic<uint64_t>, TrafficTotals::PROTOCOLS> bytes{};
+        };
+
+        std::array<std::unique_ptr<Bucket[]>, LEVELS> levels;
+};
+
+// Registro global das séries, uma por interface (mesmo modelo de Metrics::interfaceMetrics)
+class TrafficHistory
+{
+    public:
+        static TrafficHistory& instance();
+
+        // O ponteiro é estável durante toda a execução do programa
+        TrafficSeries* series(const std::string& name);
+
+        // Soma todas as interfaces: out[i] recebe os buckets
+        // [first + i * bucketsPerPoint, first + (i + 1) * bucketsPerPoint)
+        void aggregate(SeriesResolution resolution, int64_t first, size_t bucketsPerPoint,
+                       std::vector<TrafficTotals>& out) const;
+
+    private:
+        TrafficHistory() = default;
+
+        mutable std::mutex seriesMutex;
+        std::vector<std::unique_ptr<TrafficSeries>> allSeries;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "traffic.hpp"
+#include <algorithm>
+
+using namespace std;
+
+static const size_t ETHERNET_HEADER_LEN = 14;
+static const size_t IPV4_HEADER_LEN = 20;
+static const size_t IPV6_HEADER_LEN = 40;
+static const size_t TCP_HEADER_LEN = 20;
+static const size_t UDP_HEADER_LEN = 8;
+static const size_t ICMP_HEADER_LEN = 8;
+
+// Escrita em ordem de rede (big-endian)
+static void put16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+static void put32(uint8_t* p, uint32_t v)
+{
+    put16(p, static_cast<uint16_t>(v >> 16));
+    put16(p + 2, static_cast<uint16_t>(v));
+}
+
+// Checksum da Internet (RFC 1071)
+static uint16_t internetChecksum(const uint8_t* data, size_t len)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < len; i += 2)
+    {
+        sum += (static_cast<uint32_t>(data[i]) << 8) | data[i + 1];
+    }
+    if (len & 1)
+    {
+        sum += static_cast<uint32_t>(data[len - 1]) << 8;
+    }
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+static size_t transportHeaderLen(TrafficProtocol protocol)
+{
+    switch (protocol)
+    {
+        case TrafficProtocol::TCP: return TCP_HEADER_LEN;
+        case TrafficProtocol::UDP: return UDP_HEADER_LEN;
+        default: return ICMP_HEADER_LEN;
+    }
+}
+
+string TrafficGenerator::protocolName(TrafficProtocol protocol)
+{
+    switch (protocol)
+    {
+        case TrafficProtocol::TCP: return "TCP";
+        case TrafficProtocol::UDP: return "UDP";
+        default: return "ICMP";
+    }
+}
+
+vector<uint8_t> TrafficGenerator::buildFrame(const FrameSpec& spec)
+{
+    bool v6 = spec.ipVersion == IPVersion::V6;
+    size_t ipLen = v6 ? IPV6_HEADER_LEN : IPV4_HEADER_LEN;
+    size_t l4Len = transportHeaderLen(spec.protocol);
+    size_t headersLen = ETHERNET_HEADER_LEN + ipLen + l4Len;
+
+    size_t frameSize = max<size_t>({spec.frameSize, MIN_FRAME_SIZE, headersLen});
+    frameSize = min<size_t>(frameSize, max<size_t>(MAX_FRAME_SIZE, headersLen));
+
+    vector<uint8_t> frame(frameSize, 0);
+    uint8_t* eth = frame.data();
+    uint8_t* ip = eth + ETHERNET_HEADER_LEN;
+    uint8_t* l4 = ip + ipLen;
+    uint8_t* payload = l4 + l4Len;
+    size_t payloadLen = frameSize - headersLen;
+    size_t l4TotalLen = l4Len + payloadLen;
+
+    // ===== ETHERNET =====
+    // MACs localmente administrados; o de origem varia com o fluxo
+    const uint8_t dstMac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+    const uint8_t srcMac[6] = {0x02, 0x00, 0x00, static_cast<uint8_t>(spec.flowId >> 16),
+                               static_cast<uint8_t>(spec.flowId >> 8), static_cast<uint8_t>(spec.flowId)};
+    copy(dstMac, dstMac + 6, eth);
+    copy(srcMac, srcMac + 6, eth + 6);
+    put16(eth + 12, v6 ? 0x86DD : 0x0800);
+
+    uint8_t ipProto = spec.protocol == TrafficProtocol::TCP ? 6
+                    : spec.protocol == TrafficProtocol::UDP ? 17
+                    : (v6 ? 58 : 1);
+
+    // ===== IP =====
+    if (v6)
+    {
+        put32(ip, 0x60000000);
+        put16(ip + 4, static_cast<uint16_t>(l4TotalLen));
+        ip[6] = ipProto;
+        ip[7] = 64;
+        // fd00::<fluxo> -> fd00::1
+        ip[8] = 0xfd;
+        put32(ip + 20, spec.flowId + 2);
+        ip[24] = 0xfd;
+        ip[39] = 1;
+    }
+    else
+    {
+        ip[0] = 0x45;
+        put16(ip + 2, static_cast<uint16_t>(IPV4_HEADER_LEN + l4TotalLen));
+        put16(ip + 4, static_cast<uint16_t>(spec.sequence));
+        put16(ip + 6, 0x4000); // Don't Fragment
+        ip[8] = 64;
+        ip[9] = ipProto;
+        // 10.x.y.z (por fluxo) -> 192.168.0.1
+        put32(ip + 12, 0x0A000000 | ((spec.flowId + 2) & 0x00FFFFFF));
+        put32(ip + 16, 0xC0A80001);
+        put16(ip + 10, internetChecksum(ip, IPV4_HEADER_LEN));
+    }
+
+    // ===== TRANSPORTE =====
+    uint16_t srcPort = static_cast<uint16_t>(40000 + spec.flowId % 20000);
+    uint16_t dstPort = (spec.flowId & 1) ? 443 : 80;
+
+    switch (spec.protocol)
+    {
+        case TrafficProtocol::TCP:
+            put16(l4, srcPort);
+            put16(l4 + 2, dstPort);
+            put32(l4 + 4, spec.sequence * 1460u);
+            put32(l4 + 8, 1);
+            l4[12] = 5 << 4;   // Data offset: 5 palavras
+            l4[13] = 0x18;     // PSH + ACK
+            put16(l4 + 14, 65535);
+            break;
+
+        case TrafficProtocol::UDP:
+            put16(l4, srcPort);
+            put16(l4 + 2, 53);
+            put16(l4 + 4, static_cast<uint16_t>(l4TotalLen));
+            break;
+
+        case TrafficProtocol::ICMP:
+            l4[0] = v6 ? 128 : 8; // Echo Request
+            put16(l4 + 4, static_cast<uint16_t>(spec.flowId));
+            put16(l4 + 6, static_cast<uint16_t>(spec.sequence));
+            break;
+    }
+
+    // Payload determinístico
+    for (size_t i = 0; i < payloadLen; i++)
+    {
+        payload[i] = static_cast<uint8_t>((spec.sequence + i) & 0xFF);
+    }
+
+    if (spec.protocol == TrafficProtocol::ICMP && !v6)
+    {
+        put16(l4 + 2, internetChecksum(l4, l4TotalLen));
+    }
+
+    return frame;
+}
@@ -0,0 +1,45 @@
+#ifndef TRAFFIC_HPP
+#define TRAFFIC_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Protocolos de transporte que o gerador sabe montar
+enum class TrafficProtocol
+{
+    TCP,
+    UDP,
+    ICMP
+};
+
+enum class IPVersion
+{
+    V4,
+    V6
+};
+
+// Descrição de um quadro sintético
+struct FrameSpec
+{
+    TrafficProtocol protocol;
+    IPVersion ipVersion;
+    uint32_t frameSize;   // Tamanho total do quadro Ethernet (sem FCS)
+    uint32_t flowId;      // Define endereços e portas; quadros do mesmo fluxo compartilham a 5-tupla
+    uint32_t sequence;    // Usado no IP ID, no número de sequência TCP e no conteúdo do payload
+};
+
+// Gera quadros Ethernet/IP/transporte válidos para testes e benchmarks
+class TrafficGenerator
+{
+    public:
+        static constexpr uint32_t MIN_FRAME_SIZE = 60;
+        static constexpr uint32_t MAX_FRAME_SIZE = 1514;
+
+        // Monta o quadro completo; o tamanho é ajustado para caber os cabeçalhos
+        static std::vector<uint8_t> buildFrame(const FrameSpec& spec);
+
+        static std::string protocolName(TrafficProtocol protocol);
+};
+
+#endif
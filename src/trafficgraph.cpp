@@ -0,0 +1,191 @@
+#include "trafficgraph.hpp"
+#include "styles.hpp"
+#include <QPainter>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+static const char* PROTOCOL_NAMES[] = { "TCP", "UDP", "ICMP", "Outro IP", "Ethernet" };
+
+// Os pacotes chegam ao anel com o atraso do pcap_dispatch; o fim do gráfico espera por eles
+static const int64_t DISPLAY_DELAY_NS = TrafficSeries::READ_DELAY_NS;
+
+static const int MARGIN_LEFT = 70;
+static const int MARGIN_RIGHT = 8;
+static const int MARGIN_TOP = 20;
+static const int MARGIN_BOTTOM = 18;
+
+const vector<int> TrafficGraph::SPANS_SECONDS = {1, 10, 60, 600, 3600, 6 * 3600, 24 * 3600};
+
+TrafficGraph::TrafficGraph(QWidget *parent) : QWidget(parent)
+{
+    this->setMinimumHeight(140);
+
+    QObject::connect(&this->frameTimer, &QTimer::timeout, this, [this]()
+    {
+        this->update();
+    });
+    this->frameTimer.start(1000 / FRAME_RATE);
+}
+
+void TrafficGraph::setSpan(int seconds)
+{
+    this->spanSeconds = seconds;
+    this->update();
+}
+
+void TrafficGraph::setShowBits(bool bits)
+{
+    this->showBits = bits;
+    this->update();
+}
+
+QString TrafficGraph::formatRate(double value, bool bits)
+{
+    static const char* PREFIXES[] = { "", "k", "M", "G", "T" };
+    int prefix = 0;
+    while (value >= 1000.0 && prefix < 4)
+    {
+        value /= 1000.0;
+        prefix++;
+    }
+    return QString("%1 %2%3").arg(value, 0, 'f', value < 10.0 ? 1 : 0).arg(PREFIXES[prefix]).arg(bits ? "bps" : "pps");
+}
+
+QString TrafficGraph::formatSpan(int seconds)
+{
+    if (seconds >= 3600)
+    {
+        return QString("-%1 h").arg(seconds / 3600);
+    }
+    if (seconds >= 60)
+    {
+        return QString("-%1 min").arg(seconds / 60);
+    }
+    return QString("-%1 s").arg(seconds);
+}
+
+void TrafficGraph::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(this->rect(), Styles::graphBackgroundColor());
+
+    QRect plot(MARGIN_LEFT, MARGIN_TOP, this->width() - MARGIN_LEFT - MARGIN_RIGHT,
+               this->height() - MARGIN_TOP - MARGIN_BOTTOM);
+    if (plot.width() <= 0 || plot.height() <= 0)
+    {
+        return;
+    }
+
+    // Resolução mais fina cuja janela garantida cobre o intervalo inteiro
+    // (10 s usa os buckets de 1 ms, 1 h os de 1 s)
+    int64_t spanNs = static_cast<int64_t>(this->spanSeconds) * 1000000000;
+    size_t level = 0;
+    while (level + 1 < TrafficSeries::LEVELS &&
+           (spanNs + TrafficSeries::BUCKET_NS[level] - 1) / TrafficSeries::BUCKET_NS[level] >
+               static_cast<int64_t>(TrafficSeries::WINDOW[level]))
+    {
+        level++;
+    }
+    int64_t bucketNs = TrafficSeries::BUCKET_NS[level];
+    size_t bucketCount = static_cast<size_t>(max<int64_t>(1, spanNs / bucketNs));
+
+    // No máximo um ponto por pixel; cada ponto soma buckets vizinhos. Arredonda para baixo,
+    // para nunca pedir mais buckets do que a janela garantida do anel
+    size_t bucketsPerPoint = (bucketCount + plot.width() - 1) / plot.width();
+    size_t pointCount = max<size_t>(1, bucketCount / bucketsPerPoint);
+    this->points.resize(pointCount);
+
+    // Último bucket completo (o pcap usa o relógio do sistema)
+    int64_t nowNs = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    int64_t last = (nowNs - DISPLAY_DELAY_NS) / bucketNs - 1;
+    int64_t first = last - static_cast<int64_t>(pointCount * bucketsPerPoint) + 1;
+
+    TrafficHistory::instance().aggregate(static_cast<SeriesResolution>(level), first, bucketsPerPoint, this->points);
+
+    // Taxa por segundo de cada ponto e escala do eixo Y
+    double pointSeconds = static_cast<double>(bucketsPerPoint * bucketNs) / 1e9;
+    double peak = 0.0;
+    for (const TrafficTotals& point : this->points)
+    {
+        double total = 0.0;
+        for (size_t p = 0; p < TrafficTotals::PROTOCOLS; p++)
+        {
+            total += this->showBits ? point.bytes[p] * 8.0 : point.packets[p];
+        }
+        peak = max(peak, total / pointSeconds);
+    }
+
+    // Topo arredondado para 1, 2 ou 5 x 10^n
+    double top = 1.0;
+    if (peak > 0.0)
+    {
+        double magnitude = pow(10.0, floor(log10(peak)));
+        if (peak <= magnitude)
+        {
+            top = magnitude;
+        }
+        else if (peak <= 2 * magnitude)
+        {
+            top = 2 * magnitude;
+        }
+        else if (peak <= 5 * magnitude)
+        {
+            top = 5 * magnitude;
+        }
+        else
+        {
+            top = 10 * magnitude;
+        }
+    }
+
+    // Grade e rótulos
+    painter.setPen(Styles::graphGridColor());
+    for (int i = 0; i <= 4; i++)
+    {
+        int y = plot.bottom() - plot.height() * i / 4;
+        painter.drawLine(plot.left(), y, plot.right(), y);
+    }
+    painter.setPen(Styles::graphTextColor());
+    painter.drawText(QRect(0, plot.top() - 8, MARGIN_LEFT - 6, 16), Qt::AlignRight | Qt::AlignVCenter, formatRate(top, this->showBits));
+    painter.drawText(QRect(0, plot.bottom() - 8, MARGIN_LEFT - 6, 16), Qt::AlignRight | Qt::AlignVCenter, formatRate(0, this->showBits));
+    painter.drawText(QRect(plot.left(), plot.bottom() + 2, 80, MARGIN_BOTTOM), Qt::AlignLeft, formatSpan(this->spanSeconds));
+    painter.drawText(QRect(plot.right() - 80, plot.bottom() + 2, 80, MARGIN_BOTTOM), Qt::AlignRight, "agora");
+
+    // Colunas empilhadas por protocolo
+    double columnWidth = static_cast<double>(plot.width()) / pointCount;
+    for (size_t i = 0; i < pointCount; i++)
+    {
+        const TrafficTotals& point = this->points[i];
+        int x0 = plot.left() + static_cast<int>(i * columnWidth);
+        int x1 = plot.left() + static_cast<int>((i + 1) * columnWidth);
+        double stacked = 0.0;
+
+        for (size_t p = 0; p < TrafficTotals::PROTOCOLS; p++)
+        {
+            double value = (this->showBits ? point.bytes[p] * 8.0 : point.packets[p]) / pointSeconds;
+            if (value <= 0.0)
+            {
+                continue;
+            }
+
+            int yTop = plot.bottom() - static_cast<int>((stacked + value) / top * plot.height());
+            int yBottom = plot.bottom() - static_cast<int>(stacked / top * plot.height());
+            painter.fillRect(QRect(x0, yTop, max(1, x1 - x0), max(1, yBottom - yTop)), Styles::protocolColor(p));
+            stacked += value;
+        }
+    }
+
+    // Legenda
+    int x = plot.left();
+    for (size_t p = 0; p < TrafficTotals::PROTOCOLS; p++)
+    {
+        painter.fillRect(QRect(x, 5, 10, 10), Styles::protocolColor(p));
+        painter.setPen(Styles::graphTextColor());
+        painter.drawText(QRect(x + 14, 0, 70, MARGIN_TOP), Qt::AlignLeft | Qt::AlignVCenter, PROTOCOL_NAMES[p]);
+        x += 90;
+    }
+}
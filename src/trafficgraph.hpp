@@ -0,0 +1,42 @@
+#ifndef TRAFFICGRAPH_HPP
+#define TRAFFICGRAPH_HPP
+
+#include "timeseries.hpp"
+#include <QTimer>
+#include <QWidget>
+#include <vector>
+
+// Gráfico de pps/bps por protocolo (empilhado), no estilo do I/O Graph do Wireshark.
+//
+// Redesenhado por um QTimer em taxa fixa, independente do volume de pacotes: cada
+// quadro lê no máximo alguns milhares de buckets já agregados do TrafficHistory,
+// escolhendo a resolução mais fina que cobre a janela pedida.
+class TrafficGraph : public QWidget
+{
+    public:
+        static constexpr int FRAME_RATE = 20;
+
+        // Janelas oferecidas na GUI, em segundos
+        static const std::vector<int> SPANS_SECONDS;
+
+        explicit TrafficGraph(QWidget *parent = nullptr);
+
+        void setSpan(int seconds);
+        void setShowBits(bool bits);
+
+    protected:
+        void paintEvent(QPaintEvent *event) override;
+
+    private:
+        QTimer frameTimer;
+        int spanSeconds = 10;
+        bool showBits = false;
+
+        // Reaproveitado entre quadros
+        std::vector<TrafficTotals> points;
+
+        static QString formatRate(double value, bool bits);
+        static QString formatSpan(int seconds);
+};
+
+#endif